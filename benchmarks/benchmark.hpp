@@ -0,0 +1,259 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace pipeable::bench
+{
+    using bench_clock_t = std::chrono::steady_clock;
+
+    // Prevent the optimizer from discarding a computed value (or hoisting it out of the timed loop).
+    template<typename T>
+    inline void do_not_optimize(T const& value)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : "r,m"(value) : "memory");
+#else
+        static volatile const void* sink;
+        sink = &value;
+#endif
+    }
+
+    // Make the optimizer forget everything it knows about 'value'.
+    template<typename T>
+    inline void launder(T& value)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : "+r,m"(value) : : "memory");
+#else
+        do_not_optimize(value);
+#endif
+    }
+
+    struct param
+    {
+        std::string name;
+        std::int64_t value;
+    };
+
+    struct result
+    {
+        std::string name;
+        std::vector<param> params;
+        std::uint64_t iterations = 0;
+        double min_ns = 0;
+        double median_ns = 0;
+        double mean_ns = 0;
+        double items_per_op = 1;
+    };
+
+    // Passed to each benchmark body. Body runs 'iterations()' operations and returns,
+    // optionally overriding the measured duration (eg. when timing is done inside worker threads).
+    struct state
+    {
+        explicit state(std::uint64_t iterations) :
+            iterations_(iterations)
+        {}
+
+        std::uint64_t iterations() const
+        {
+            return iterations_;
+        }
+
+        void set_elapsed(bench_clock_t::duration elapsed)
+        {
+            elapsed_ = elapsed;
+            manualTiming_ = true;
+        }
+
+        void set_items_per_op(double items)
+        {
+            itemsPerOp_ = items;
+        }
+
+    private:
+        friend struct runner;
+
+        std::uint64_t iterations_;
+        bench_clock_t::duration elapsed_{};
+        bool manualTiming_ = false;
+        double itemsPerOp_ = 1;
+    };
+
+    /*
+    Minimal benchmark runner: calibrates iteration count until a sample takes at least 'min_sample_time',
+    then records 'repetitions' samples and reports per-operation statistics as JSON.
+    */
+    struct runner
+    {
+        std::string filter;
+        std::chrono::milliseconds min_sample_time{ 50 };
+        std::size_t repetitions = 5;
+
+        template<typename body_t>
+        void run(std::string name, std::vector<param> params, body_t&& body)
+        {
+            auto fullName = name;
+            for (const auto& p : params)
+            {
+                fullName += "/" + p.name + ":" + std::to_string(p.value);
+            }
+            if (!filter.empty() && fullName.find(filter) == std::string::npos)
+            {
+                return;
+            }
+
+            // Calibrate
+            std::uint64_t iterations = 1;
+            double itemsPerOp = 1;
+            for (;;)
+            {
+                const auto elapsed = sample(body, iterations, itemsPerOp);
+                if (elapsed >= min_sample_time || iterations >= (std::uint64_t{ 1 } << 40))
+                {
+                    break;
+                }
+                const auto ratio = elapsed.count() > 0 ? double(std::chrono::duration_cast<bench_clock_t::duration>(min_sample_time).count()) / double(elapsed.count()) : 10.0;
+                iterations = std::max<std::uint64_t>(iterations + 1, std::uint64_t(double(iterations) * std::clamp(ratio * 1.2, 1.5, 10.0)));
+            }
+
+            // At least one sample (min & median of none are undefined)
+            std::vector<double> samples;
+            for (std::size_t i = 0; i < std::max<std::size_t>(repetitions, 1); ++i)
+            {
+                const auto elapsed = std::chrono::duration<double, std::nano>(sample(body, iterations, itemsPerOp));
+                samples.push_back(elapsed.count() / double(iterations));
+            }
+            std::sort(samples.begin(), samples.end());
+
+            result res;
+            res.name = std::move(name);
+            res.params = std::move(params);
+            res.iterations = iterations;
+            res.min_ns = samples.front();
+            res.median_ns = samples[samples.size() / 2];
+            for (auto s : samples)
+            {
+                res.mean_ns += s / double(samples.size());
+            }
+            res.items_per_op = itemsPerOp;
+            results_.push_back(std::move(res));
+
+            if (progress_)
+            {
+                progress_(results_.back());
+            }
+        }
+
+        void on_progress(std::function<void(const result&)> progress)
+        {
+            progress_ = std::move(progress);
+        }
+
+        const std::vector<result>& results() const
+        {
+            return results_;
+        }
+
+        void write_json(std::ostream& out, const std::string& executable) const
+        {
+            out << "{\n";
+            out << "  \"context\": {\n";
+            out << "    \"executable\": \"" << escape(executable) << "\",\n";
+            out << "    \"date\": " << std::time(nullptr) << ",\n";
+            out << "    \"compiler\": \"" << escape(compiler()) << "\",\n";
+            out << "    \"build_type\": \"" << build_type() << "\"\n";
+            out << "  },\n";
+            out << "  \"benchmarks\": [";
+            for (std::size_t i = 0; i < results_.size(); ++i)
+            {
+                const auto& r = results_[i];
+                out << (i == 0 ? "\n" : ",\n");
+                out << "    {\"name\": \"" << escape(r.name) << "\", \"params\": {";
+                for (std::size_t p = 0; p < r.params.size(); ++p)
+                {
+                    out << (p == 0 ? "" : ", ") << "\"" << escape(r.params[p].name) << "\": " << r.params[p].value;
+                }
+                out << "}, \"iterations\": " << r.iterations
+                    << ", \"min_ns\": " << r.min_ns
+                    << ", \"median_ns\": " << r.median_ns
+                    << ", \"mean_ns\": " << r.mean_ns
+                    << ", \"items_per_op\": " << r.items_per_op
+                    << ", \"ns_per_item\": " << r.median_ns / r.items_per_op
+                    << "}";
+            }
+            out << "\n  ]\n}\n";
+        }
+
+    private:
+        template<typename body_t>
+        static bench_clock_t::duration sample(body_t& body, std::uint64_t iterations, double& itemsPerOp)
+        {
+            state st(iterations);
+            const auto start = bench_clock_t::now();
+            body(st);
+            const auto stop = bench_clock_t::now();
+            itemsPerOp = st.itemsPerOp_;
+            return st.manualTiming_ ? st.elapsed_ : stop - start;
+        }
+
+        static std::string escape(const std::string& str)
+        {
+            std::string escaped;
+            for (auto c : str)
+            {
+                if (c == '"' || c == '\\')
+                {
+                    escaped += '\\';
+                    escaped += c;
+                }
+                else if (static_cast<unsigned char>(c) < 0x20)
+                {
+                    // Control characters must be escaped in JSON strings
+                    char code[7];
+                    std::snprintf(code, sizeof(code), "\\u%04x", static_cast<unsigned>(static_cast<unsigned char>(c)));
+                    escaped += code;
+                }
+                else
+                {
+                    escaped += c;
+                }
+            }
+            return escaped;
+        }
+
+        static std::string compiler()
+        {
+#if defined(__clang__)
+            return std::string("clang ") + __clang_version__;
+#elif defined(__GNUC__)
+            return std::string("gcc ") + __VERSION__;
+#elif defined(_MSC_VER)
+            return "msvc " + std::to_string(_MSC_VER);
+#else
+            return "unknown";
+#endif
+        }
+
+        static const char* build_type()
+        {
+#if defined(NDEBUG)
+            return "release";
+#else
+            return "debug";
+#endif
+        }
+
+        std::vector<result> results_;
+        std::function<void(const result&)> progress_;
+    };
+}
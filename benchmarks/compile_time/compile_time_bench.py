@@ -0,0 +1,86 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+Compile-time benchmark: generates translation units composing & invoking N-stage pipelines
+and reports compile time (seconds) and peak compiler memory (MiB) per stage count as JSON.
+
+Usage: compile_time_bench.py --compiler g++ --include <repo>/include [--stages 1,2,4,...] [--flags "-O0"]
+"""
+
+import argparse
+import json
+import os
+import subprocess
+import sys
+import tempfile
+import time
+
+TEMPLATE = """
+#include <pipeable/pipeable.hpp>
+using pipeable::operator>>=;
+
+template<int i>
+struct stage
+{{
+    int operator()(int val) const {{ return val * 3 + i; }}
+}};
+
+int run_operator(int val)
+{{
+    return val >>= {operator_stages};
+}}
+
+int run_compose(int val)
+{{
+    const auto pipe = pipeable::assembly::compose({compose_stages});
+    return pipeable::invocation::invoke(pipe, val);
+}}
+"""
+
+
+def generate(stages):
+    operator_stages = " >>= ".join("stage<{}>{{}}".format(i) for i in range(stages))
+    compose_stages = ", ".join("stage<{}>{{}}".format(stages + i) for i in range(stages))
+    return TEMPLATE.format(operator_stages=operator_stages, compose_stages=compose_stages)
+
+
+def measure(compiler, include, flags, source):
+    cmd = [compiler, "-std=c++17", "-c", source, "-o", os.devnull, "-I", include] + flags
+    start = time.perf_counter()
+    process = subprocess.Popen(cmd)
+    _, status, usage = os.wait4(process.pid, 0)
+    elapsed = time.perf_counter() - start
+    if os.waitstatus_to_exitcode(status) != 0:
+        raise RuntimeError("Compilation failed: " + " ".join(cmd))
+    # ru_maxrss is in KiB on Linux (includes the compiler driver's reaped children, eg. cc1plus)
+    return elapsed, usage.ru_maxrss / 1024.0
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--compiler", default="g++")
+    parser.add_argument("--include", default=os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "..", "include"))
+    parser.add_argument("--stages", default="1,2,4,8,16,32,40,64")
+    parser.add_argument("--flags", default="-O0")
+    parser.add_argument("--repetitions", type=int, default=3)
+    args = parser.parse_args()
+
+    results = []
+    with tempfile.TemporaryDirectory() as tmp:
+        for stages in [int(s) for s in args.stages.split(",")]:
+            source = os.path.join(tmp, "stages_{}.cpp".format(stages))
+            with open(source, "w") as f:
+                f.write(generate(max(stages, 2)))
+            samples = [measure(args.compiler, args.include, args.flags.split(), source) for _ in range(args.repetitions)]
+            seconds = sorted(s[0] for s in samples)[len(samples) // 2]
+            memory = max(s[1] for s in samples)
+            print("stages:{:<4} {:8.3f} s {:10.1f} MiB".format(stages, seconds, memory), file=sys.stderr)
+            results.append({"stages": stages, "compile_seconds": seconds, "peak_memory_mib": memory})
+
+    json.dump({"compiler": args.compiler, "flags": args.flags, "results": results}, sys.stdout, indent=2)
+    print()
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,173 @@
+#include "benchmark.hpp"
+
+#include <pipeable/data_generator.hpp>
+#include <pipeable/static_generator.hpp>
+
+#include <cstdint>
+#include <vector>
+
+using namespace pipeable;
+
+namespace
+{
+    struct accumulator
+    {
+        void operator()(int val)
+        {
+            sum += std::uint64_t(val);
+        }
+        std::uint64_t sum = 0;
+    };
+
+    struct batch_accumulator : batch_receiver
+    {
+        void operator()(int val)
+        {
+            sum += std::uint64_t(val);
+        }
+        void operator()(span<const int> values)
+        {
+            for (const auto val : values)
+            {
+                sum += std::uint64_t(val);
+            }
+        }
+        std::uint64_t sum = 0;
+    };
+
+    constexpr std::size_t batch_size = 256;
+
+    // Emit 'batch_size' values per iteration to 'count' receivers of type 'receiver_t'
+    template<typename receiver_t>
+    void run_emit_batch(bench::runner& runner, const char* name, std::int64_t count)
+    {
+        runner.run(name, { { "receivers", count }, { "batch", std::int64_t(batch_size) } }, [count](bench::state& state) {
+            std::vector<receiver_t> receivers(count);
+            data_generator<int> generator;
+            for (auto& receiver : receivers)
+            {
+                generator += &receiver;
+            }
+            std::vector<int> values(batch_size);
+            for (std::uint64_t i = 0; i < state.iterations(); ++i)
+            {
+                values.front() = int(i);
+                bench::launder(values);
+                generator.emit_batch(values);
+                bench::do_not_optimize(receivers.front().sum);
+            }
+            state.set_items_per_op(double(count) * batch_size);
+        });
+    }
+
+    constexpr int receiver_counts[] = { 1, 10, 100, 1'000, 10'000 };
+
+    template<std::size_t... indexes>
+    auto make_static_generator(std::vector<accumulator>& receivers, std::index_sequence<indexes...>)
+    {
+        return static_generator(&receivers[indexes]...);
+    }
+
+    template<std::size_t count>
+    void run_static_generator(bench::runner& runner)
+    {
+        runner.run("data_generator/static_generator", { { "receivers", std::int64_t(count) } }, [](bench::state& state) {
+            std::vector<accumulator> receivers(count);
+            auto generator = make_static_generator(receivers, std::make_index_sequence<count>());
+            for (std::uint64_t i = 0; i < state.iterations(); ++i)
+            {
+                generator(int(i));
+                bench::do_not_optimize(receivers.front().sum);
+            }
+            state.set_items_per_op(count);
+        });
+    }
+}
+
+namespace pipeable::bench
+{
+    void run_data_generator_benchmarks(runner& runner)
+    {
+        for (const auto count : receiver_counts)
+        {
+            const std::vector<param> params = { { "receivers", count } };
+
+            runner.run("data_generator/direct_calls", params, [count](state& state) {
+                std::vector<accumulator> receivers(count);
+                for (std::uint64_t i = 0; i < state.iterations(); ++i)
+                {
+                    for (auto& receiver : receivers)
+                    {
+                        receiver(int(i));
+                    }
+                    do_not_optimize(receivers.front().sum);
+                }
+                state.set_items_per_op(count);
+            });
+
+            runner.run("data_generator/emit_pointer_receivers", params, [count](state& state) {
+                std::vector<accumulator> receivers(count);
+                data_generator<int> generator;
+                for (auto& receiver : receivers)
+                {
+                    generator += &receiver;
+                }
+                for (std::uint64_t i = 0; i < state.iterations(); ++i)
+                {
+                    generator(int(i));
+                    do_not_optimize(receivers.front().sum);
+                }
+                state.set_items_per_op(count);
+            });
+
+            runner.run("data_generator/emit_lambda_receivers", params, [count](state& state) {
+                std::vector<accumulator> receivers(count);
+                data_generator<int> generator;
+                for (auto& receiver : receivers)
+                {
+                    generator += [sum = &receiver.sum](int val) { *sum += std::uint64_t(val); };
+                }
+                for (std::uint64_t i = 0; i < state.iterations(); ++i)
+                {
+                    generator(int(i));
+                    do_not_optimize(receivers.front().sum);
+                }
+                state.set_items_per_op(count);
+            });
+        }
+
+        for (const auto count : { 1, 10, 100 })
+        {
+            run_emit_batch<accumulator>(runner, "data_generator/emit_batch_per_value_receivers", count);
+            run_emit_batch<batch_accumulator>(runner, "data_generator/emit_batch_batch_receivers", count);
+        }
+
+        // Registration churn on a generator with many (lambda) subscribers: subscribe one & unsubscribe a random one by handle
+        for (const auto count : { 1'000, 50'000 })
+        {
+            runner.run("data_generator/churn_by_subscription", { { "receivers", count } }, [count](state& state) {
+                accumulator receiver;
+                data_generator<int> generator;
+                std::vector<subscription<int>> subscriptions;
+                for (int i = 0; i < count; ++i)
+                {
+                    subscriptions.push_back(generator += [sum = &receiver.sum](int val) { *sum += std::uint64_t(val); });
+                }
+                std::uint32_t random = 1;
+                for (std::uint64_t i = 0; i < state.iterations(); ++i)
+                {
+                    random = random * 1'664'525u + 1'013'904'223u;
+                    auto& sub = subscriptions[random % subscriptions.size()];
+                    generator -= sub;
+                    sub = generator += [sum = &receiver.sum](int val) { *sum += std::uint64_t(val); };
+                }
+                generator(1);
+                do_not_optimize(receiver.sum);
+            });
+        }
+
+        run_static_generator<1>(runner);
+        run_static_generator<10>(runner);
+        run_static_generator<100>(runner);
+    }
+}
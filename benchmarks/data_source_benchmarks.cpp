@@ -0,0 +1,363 @@
+#include "benchmark.hpp"
+
+#include <pipeable/channel.hpp>
+#include <pipeable/data_source.hpp>
+#include <pipeable/mmap_line_source.hpp>
+#include <pipeable/pipeable.hpp>
+#include <pipeable/prefetching_source.hpp>
+#include <pipeable/static_data_source.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace pipeable;
+
+namespace
+{
+    struct vector_source final : data_source<int>
+    {
+        explicit vector_source(const std::vector<int>& vals) :
+            vals_(vals)
+        {}
+
+        std::optional<int> next() override
+        {
+            return current_ < vals_.size() ? std::optional<int>(vals_[current_++]) : std::nullopt;
+        }
+
+    private:
+        const std::vector<int>& vals_;
+        std::size_t current_ = 0;
+    };
+
+    // Same values, pulled a block per (virtual) call
+    struct batched_vector_source final : data_source<int>
+    {
+        explicit batched_vector_source(const std::vector<int>& vals) :
+            vals_(vals)
+        {}
+
+        std::optional<int> next() override
+        {
+            return current_ < vals_.size() ? std::optional<int>(vals_[current_++]) : std::nullopt;
+        }
+
+        std::size_t next_batch(span<int> values) override
+        {
+            const auto count = std::min(values.size(), vals_.size() - current_);
+            std::copy_n(vals_.begin() + current_, count, values.begin());
+            current_ += count;
+            return count;
+        }
+
+        bool supports_batch() const noexcept override
+        {
+            return true;
+        }
+
+    private:
+        const std::vector<int>& vals_;
+        std::size_t current_ = 0;
+    };
+
+    // Same values, without virtual dispatch
+    struct static_vector_source : static_data_source<static_vector_source, int>
+    {
+        explicit static_vector_source(const std::vector<int>& vals) :
+            vals_(vals)
+        {}
+
+        std::optional<int> next()
+        {
+            return current_ < vals_.size() ? std::optional<int>(vals_[current_++]) : std::nullopt;
+        }
+
+    private:
+        const std::vector<int>& vals_;
+        std::size_t current_ = 0;
+    };
+
+    // Stand-in for decoding / processing a value
+    std::uint64_t busy_work(std::uint64_t value, int rounds)
+    {
+        for (int i = 0; i < rounds; ++i)
+        {
+            value = value * 6364136223846793005ULL + 1442695040888963407ULL;
+        }
+        return value;
+    }
+
+    // Values taking 'rounds' of work each to produce
+    struct decoding_source final : data_source<std::uint64_t>
+    {
+        decoding_source(std::size_t count, int rounds) :
+            count_(count),
+            rounds_(rounds)
+        {}
+
+        std::optional<std::uint64_t> next() override
+        {
+            return current_ < count_ ? std::optional<std::uint64_t>(busy_work(current_++, rounds_)) : std::nullopt;
+        }
+
+    private:
+        std::size_t count_;
+        int rounds_;
+        std::size_t current_ = 0;
+    };
+
+    // Lines of a file, copied in a string each
+    struct getline_source final : data_source<std::string>
+    {
+        explicit getline_source(const std::string& path) :
+            file_(path)
+        {}
+
+        std::optional<std::string> next() override
+        {
+            std::string line;
+            return std::getline(file_, line) ? std::optional<std::string>(std::move(line)) : std::nullopt;
+        }
+
+    private:
+        std::ifstream file_;
+    };
+
+    struct accumulator
+    {
+        void operator()(int val)
+        {
+            sum += std::uint64_t(val);
+        }
+        std::uint64_t sum = 0;
+    };
+
+    constexpr int element_counts[] = { 1'000, 100'000 };
+}
+
+namespace pipeable::bench
+{
+    // Hand values from a producer thread to a consumer (this thread) through a channel, one at a time or in batches
+    template<channel_mode mode>
+    void run_channel_benchmark(runner& runner, const char* name)
+    {
+        for (const auto batch : { 1, 64 })
+        {
+            runner.run(name, { { "batch", batch } }, [=](state& state) {
+                channel<int, mode> chan{ 1024 };
+                const auto count = state.iterations();
+                std::thread producer([&] {
+                    std::vector<int> vals(batch, 1);
+                    for (std::uint64_t i = 0; i < count; i += batch)
+                    {
+                        if (batch == 1)
+                        {
+                            1 >>= chan;
+                        }
+                        else
+                        {
+                            chan.push_batch(vals);
+                        }
+                    }
+                    chan.close();
+                });
+
+                accumulator acc;
+                if (batch == 1)
+                {
+                    chan >>= for_each >>= &acc;
+                }
+                else
+                {
+                    std::vector<int> vals(batch);
+                    while (auto pulled = chan.pop_batch(vals))
+                    {
+                        for (std::size_t i = 0; i < pulled; ++i)
+                        {
+                            acc(vals[i]);
+                        }
+                    }
+                }
+                producer.join();
+                do_not_optimize(acc.sum);
+            });
+        }
+    }
+
+    // Producing & consuming a value take the same work: prefetching overlaps both (given 2 cores)
+    void run_prefetching_benchmark(runner& runner)
+    {
+        constexpr std::size_t count = 10'000;
+        constexpr int rounds = 500;
+        for (const auto prefetch : { 0, 1 })
+        {
+            runner.run("prefetching_source/two_stage", { { "prefetch", prefetch } }, [=](state& state) {
+                for (std::uint64_t i = 0; i < state.iterations(); ++i)
+                {
+                    decoding_source source(count, rounds);
+                    std::uint64_t sum = 0;
+                    const auto consume = [&](std::uint64_t val) { sum += busy_work(val, rounds); };
+                    if (prefetch)
+                    {
+                        prefetching_source<std::uint64_t> prefetching(source);
+                        prefetching >>= for_each >>= consume;
+                    }
+                    else
+                    {
+                        source >>= for_each >>= consume;
+                    }
+                    do_not_optimize(sum);
+                }
+                state.set_items_per_op(count);
+            });
+        }
+    }
+
+    // Pull the lines of a (page cached) log-like file
+    void run_line_source_benchmarks(runner& runner)
+    {
+        constexpr int count = 100'000;
+        // In the working directory: std::filesystem needs extra linking (or is missing) on some supported toolchains
+        const std::string path = "pipeable_bench_lines.txt";
+        {
+            std::ofstream file(path, std::ios::binary);
+            for (int i = 0; i < count; ++i)
+            {
+                file << "2024-01-01T00:00:00 INFO request " << i << " served in 12ms\n";
+            }
+        }
+        const std::vector<param> params = { { "lines", count } };
+
+        runner.run("line_source/getline", params, [&](state& state) {
+            for (std::uint64_t i = 0; i < state.iterations(); ++i)
+            {
+                getline_source source(path);
+                std::size_t bytes = 0;
+                source >>= for_each >>= [&](const std::string& line) { bytes += line.size(); };
+                do_not_optimize(bytes);
+            }
+            state.set_items_per_op(count);
+        });
+
+        runner.run("line_source/mmap", params, [&](state& state) {
+            for (std::uint64_t i = 0; i < state.iterations(); ++i)
+            {
+                mmap_line_source source(path);
+                std::size_t bytes = 0;
+                source >>= for_each >>= [&](std::string_view line) { bytes += line.size(); };
+                do_not_optimize(bytes);
+            }
+            state.set_items_per_op(count);
+        });
+        std::remove(path.c_str());
+    }
+
+    void run_data_source_benchmarks(runner& runner)
+    {
+        for (const auto count : element_counts)
+        {
+            const std::vector<param> params = { { "elements", count } };
+            std::vector<int> vals(count);
+            std::iota(vals.begin(), vals.end(), 0);
+
+            runner.run("data_source/raw_vector_loop", params, [&](state& state) {
+                for (std::uint64_t i = 0; i < state.iterations(); ++i)
+                {
+                    accumulator acc;
+                    for (auto val : vals)
+                    {
+                        acc(val);
+                    }
+                    do_not_optimize(acc.sum);
+                }
+                state.set_items_per_op(count);
+            });
+
+            runner.run("data_source/range_for", params, [&](state& state) {
+                for (std::uint64_t i = 0; i < state.iterations(); ++i)
+                {
+                    vector_source source(vals);
+                    accumulator acc;
+                    for (auto val : source)
+                    {
+                        acc(val);
+                    }
+                    do_not_optimize(acc.sum);
+                }
+                state.set_items_per_op(count);
+            });
+
+            runner.run("data_source/for_each_pipe", params, [&](state& state) {
+                for (std::uint64_t i = 0; i < state.iterations(); ++i)
+                {
+                    vector_source source(vals);
+                    accumulator acc;
+                    source >>= for_each >>= &acc;
+                    do_not_optimize(acc.sum);
+                }
+                state.set_items_per_op(count);
+            });
+
+            // Dynamic type unknown to for_each: a virtual supports_batch() per pull, then a virtual next() per value
+            runner.run("data_source/for_each_pipe_base_ref", params, [&](state& state) {
+                for (std::uint64_t i = 0; i < state.iterations(); ++i)
+                {
+                    vector_source source(vals);
+                    data_source<int>* base = &source;
+                    launder(base);
+                    accumulator acc;
+                    *base >>= for_each >>= &acc;
+                    do_not_optimize(acc.sum);
+                }
+                state.set_items_per_op(count);
+            });
+
+            runner.run("data_source/for_each_pipe_batched", params, [&](state& state) {
+                for (std::uint64_t i = 0; i < state.iterations(); ++i)
+                {
+                    batched_vector_source source(vals);
+                    accumulator acc;
+                    source >>= for_each >>= &acc;
+                    do_not_optimize(acc.sum);
+                }
+                state.set_items_per_op(count);
+            });
+
+            runner.run("static_data_source/range_for", params, [&](state& state) {
+                for (std::uint64_t i = 0; i < state.iterations(); ++i)
+                {
+                    static_vector_source source(vals);
+                    accumulator acc;
+                    for (auto val : source)
+                    {
+                        acc(val);
+                    }
+                    do_not_optimize(acc.sum);
+                }
+                state.set_items_per_op(count);
+            });
+
+            runner.run("static_data_source/for_each_pipe", params, [&](state& state) {
+                for (std::uint64_t i = 0; i < state.iterations(); ++i)
+                {
+                    static_vector_source source(vals);
+                    accumulator acc;
+                    source >>= for_each >>= &acc;
+                    do_not_optimize(acc.sum);
+                }
+                state.set_items_per_op(count);
+            });
+        }
+
+        run_prefetching_benchmark(runner);
+        run_line_source_benchmarks(runner);
+        run_channel_benchmark<channel_mode::spsc>(runner, "channel/spsc");
+        run_channel_benchmark<channel_mode::mpmc>(runner, "channel/mpmc");
+    }
+}
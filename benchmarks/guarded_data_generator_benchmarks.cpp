@@ -0,0 +1,287 @@
+#include "benchmark.hpp"
+
+#include <pipeable/async_data_generator.hpp>
+#include <pipeable/guarded_data_generator.hpp>
+#include <pipeable/ring_generator.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+using namespace pipeable;
+
+namespace
+{
+    struct accumulator
+    {
+        void operator()(int val)
+        {
+            sum.fetch_add(std::uint64_t(val), std::memory_order_relaxed);
+        }
+        std::atomic<std::uint64_t> sum = 0;
+    };
+
+    constexpr int emitter_counts[] = { 1, 2, 4, 8 };
+    constexpr int modifier_counts[] = { 0, 1, 4 };
+    constexpr int registered_receivers = 16;
+    constexpr int scaling_emitter_counts[] = { 1, 2, 4, 8, 16, 32, 64 };
+}
+
+namespace pipeable::bench
+{
+    // Wire up (then tear down) many receivers, one modification at a time or as a single transaction
+    void run_guarded_data_generator_wiring(runner& runner)
+    {
+        for (const auto count : { 1'000, 20'000 })
+        {
+            for (const auto bulk : { 0, 1 })
+            {
+                if (count > 1'000 && !bulk)
+                {
+                    continue; // Quadratic, too slow to be useful
+                }
+                runner.run("guarded_data_generator/wire_receivers", { { "receivers", count }, { "bulk", bulk } }, [=](state& state) {
+                    std::vector<accumulator> receivers(count);
+                    for (std::uint64_t i = 0; i < state.iterations(); ++i)
+                    {
+                        guarded_data_generator<int> generator;
+                        if (bulk)
+                        {
+                            generator.modify([&](auto& tx) {
+                                for (auto& receiver : receivers)
+                                {
+                                    tx += &receiver;
+                                }
+                            });
+                        }
+                        else
+                        {
+                            for (auto& receiver : receivers)
+                            {
+                                generator += &receiver;
+                            }
+                        }
+                        generator(1);
+                    }
+                    do_not_optimize(receivers.front().sum);
+                    state.set_items_per_op(count);
+                });
+            }
+        }
+    }
+
+    // Emitting threads only (no modifications): measures the read-side cost of snapshotting the receiver list
+    void run_guarded_data_generator_scaling(runner& runner)
+    {
+        for (const auto emitters : scaling_emitter_counts)
+        {
+            runner.run("guarded_data_generator/emit_scaling", { { "emitters", emitters } }, [=](state& state) {
+                // Receiver touches no shared state, so the generator itself is the only shared cache line(s)
+                guarded_data_generator<int> generator;
+                generator += [](int val) { do_not_optimize(val); };
+
+                std::atomic_bool start = false;
+                std::atomic_int emittersDone = 0;
+                std::vector<std::thread> threads;
+
+                const auto perEmitter = std::max<std::uint64_t>(1, state.iterations() / emitters);
+                for (int e = 0; e < emitters; ++e)
+                {
+                    threads.emplace_back([&] {
+                        while (!start) { std::this_thread::yield(); }
+                        for (std::uint64_t i = 0; i < perEmitter; ++i)
+                        {
+                            generator(int(i));
+                        }
+                        ++emittersDone;
+                    });
+                }
+
+                const auto begin = bench_clock_t::now();
+                start = true;
+                while (emittersDone < emitters) { std::this_thread::yield(); }
+                state.set_elapsed(bench_clock_t::now() - begin);
+
+                for (auto& thread : threads)
+                {
+                    thread.join();
+                }
+            });
+        }
+    }
+
+    // Emit to receivers invoked asynchronously (one queue per receiver), including the time to drain all queues
+    void run_async_data_generator_benchmarks(runner& runner)
+    {
+        for (const auto count : { 1, 10, 100 })
+        {
+            runner.run("async_data_generator/emit_and_drain", { { "receivers", count } }, [=](state& state) {
+                thread_pool pool;
+                async_data_generator<int> generator{ pool };
+                std::vector<accumulator> receivers(count);
+                for (auto& receiver : receivers)
+                {
+                    generator += &receiver;
+                }
+                for (std::uint64_t i = 0; i < state.iterations(); ++i)
+                {
+                    generator(int(i));
+                }
+                generator.wait_idle();
+                do_not_optimize(receivers.front().sum);
+                state.set_items_per_op(count);
+            });
+        }
+    }
+
+    // Same fan-out as emit_and_drain, through a preallocated ring read in place by each consumer (thread)
+    void run_ring_generator_benchmarks(runner& runner)
+    {
+        for (const auto count : { 1, 4 })
+        {
+            runner.run("ring_generator/publish_and_consume", { { "consumers", count } }, [=](state& state) {
+                ring_generator<int> ring{ 1024 };
+                std::vector<accumulator> consumers(count);
+                for (auto& consumer : consumers)
+                {
+                    ring += &consumer;
+                }
+                ring.start();
+                for (std::uint64_t i = 0; i < state.iterations(); ++i)
+                {
+                    ring(int(i));
+                }
+                ring.stop();
+                do_not_optimize(consumers.front().sum);
+                state.set_items_per_op(count);
+            });
+        }
+    }
+
+    // Emit to a receiver slower than the emitter: blocking bounds the emission rate to the receiver's, dropping doesn't
+    template<typename policy_t>
+    void run_async_overload_benchmark(runner& runner, const char* policy)
+    {
+        runner.run("async_data_generator/overload", { { policy, 1 } }, [](state& state) {
+            thread_pool pool{ 1 };
+            basic_async_data_generator<policy_t, int> generator{ pool, 64 };
+            generator += [](int val) {
+                for (int i = 0; i < 100; ++i)
+                {
+                    do_not_optimize(val += i);
+                }
+            };
+            const auto begin = bench_clock_t::now();
+            for (std::uint64_t i = 0; i < state.iterations(); ++i)
+            {
+                generator(int(i));
+            }
+            state.set_elapsed(bench_clock_t::now() - begin);
+            generator.wait_idle();
+        });
+    }
+
+    // One emission to many CPU heavy receivers, invoked sequentially or spread over a thread pool
+    void run_guarded_data_generator_fan_out(runner& runner)
+    {
+        for (const auto parallel : { 0, 1 })
+        {
+            runner.run("guarded_data_generator/fan_out", { { "receivers", 256 }, { "parallel", parallel } }, [=](state& state) {
+                thread_pool pool;
+                guarded_data_generator<int> generator;
+                generator.set_fan_out({ parallel ? &pool : nullptr, 64, 16, true });
+                std::vector<accumulator> receivers(256);
+                for (auto& receiver : receivers)
+                {
+                    generator += [&receiver](int val) {
+                        // Some work per receiver, so that it outweighs scheduling
+                        auto hash = std::uint64_t(val);
+                        for (int i = 0; i < 1'000; ++i)
+                        {
+                            hash = hash * 6364136223846793005ull + 1442695040888963407ull;
+                        }
+                        receiver(int(hash & 1));
+                    };
+                }
+                for (std::uint64_t i = 0; i < state.iterations(); ++i)
+                {
+                    generator(int(i));
+                }
+                do_not_optimize(receivers.front().sum);
+                state.set_items_per_op(256);
+            });
+        }
+    }
+
+    // Readers (emitting threads) traverse the receiver list while writers (modifying threads) keep adding & removing receivers.
+    void run_guarded_data_generator_benchmarks(runner& runner)
+    {
+        for (const auto emitters : emitter_counts)
+        {
+            for (const auto modifiers : modifier_counts)
+            {
+                const std::vector<param> params = { { "emitters", emitters }, { "modifiers", modifiers } };
+
+                runner.run("guarded_data_generator/emit_under_contention", params, [=](state& state) {
+                    guarded_data_generator<int> generator;
+                    std::vector<accumulator> receivers(registered_receivers);
+                    for (auto& receiver : receivers)
+                    {
+                        generator += &receiver;
+                    }
+
+                    std::atomic_bool start = false;
+                    std::atomic_int emittersDone = 0;
+                    std::vector<std::thread> threads;
+
+                    for (int m = 0; m < modifiers; ++m)
+                    {
+                        threads.emplace_back([&] {
+                            while (!start) { std::this_thread::yield(); }
+                            accumulator churn;
+                            while (emittersDone < emitters)
+                            {
+                                generator += &churn;
+                                generator -= &churn;
+                            }
+                        });
+                    }
+
+                    const auto perEmitter = std::max<std::uint64_t>(1, state.iterations() / emitters);
+                    for (int e = 0; e < emitters; ++e)
+                    {
+                        threads.emplace_back([&] {
+                            while (!start) { std::this_thread::yield(); }
+                            for (std::uint64_t i = 0; i < perEmitter; ++i)
+                            {
+                                generator(int(i));
+                            }
+                            ++emittersDone;
+                        });
+                    }
+
+                    const auto begin = bench_clock_t::now();
+                    start = true;
+                    while (emittersDone < emitters) { std::this_thread::yield(); }
+                    state.set_elapsed(bench_clock_t::now() - begin);
+
+                    for (auto& thread : threads)
+                    {
+                        thread.join();
+                    }
+                    do_not_optimize(receivers.front().sum);
+                    state.set_items_per_op(registered_receivers);
+                });
+            }
+        }
+
+        run_guarded_data_generator_scaling(runner);
+        run_guarded_data_generator_wiring(runner);
+        run_async_data_generator_benchmarks(runner);
+        run_guarded_data_generator_fan_out(runner);
+        run_async_overload_benchmark<backpressure::block>(runner, "block");
+        run_async_overload_benchmark<backpressure::drop_newest>(runner, "drop_newest");
+        run_ring_generator_benchmarks(runner);
+    }
+}
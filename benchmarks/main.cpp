@@ -0,0 +1,127 @@
+#include "benchmark.hpp"
+
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+namespace pipeable::bench
+{
+    void run_pipeable_benchmarks(runner&);
+    void run_data_generator_benchmarks(runner&);
+    void run_guarded_data_generator_benchmarks(runner&);
+    void run_data_source_benchmarks(runner&);
+    void run_stage_registry_benchmarks(runner&);
+}
+
+namespace
+{
+    constexpr const char* usage = "Usage: pipeable_bench [--filter <substring>] [--out <file.json>] [--min-time <ms>] [--repetitions <n>]\n";
+
+    // Whole argument as an integer of at least 'min', else throws std::invalid_argument
+    long long parse_integer(const std::string& arg, const std::string& value, long long min)
+    {
+        std::size_t end = 0;
+        long long parsed = 0;
+        try
+        {
+            parsed = std::stoll(value, &end);
+        }
+        catch (const std::exception&)
+        {
+            end = 0;
+        }
+        if (end == 0 || end != value.size() || parsed < min)
+        {
+            throw std::invalid_argument("Invalid value for argument " + arg + ": " + value + " (expected an integer >= " + std::to_string(min) + ")");
+        }
+        return parsed;
+    }
+}
+
+/*
+Usage: pipeable_bench [--filter <substring>] [--out <file.json>] [--min-time <ms>] [--repetitions <n>]
+Results are written as JSON (to stdout unless --out is given), progress is written to stderr.
+Returns non-zero on invalid arguments, or if results couldn't be written.
+*/
+int main(int argc, char* argv[])
+{
+    using namespace pipeable;
+
+    bench::runner runner;
+    std::string outFile;
+    try
+    {
+        for (int i = 1; i < argc; i += 2)
+        {
+            const std::string arg = argv[i];
+            if (i + 1 == argc)
+            {
+                throw std::invalid_argument("Missing value for argument: " + arg);
+            }
+            const std::string value = argv[i + 1];
+            if (arg == "--filter")
+            {
+                runner.filter = value;
+            }
+            else if (arg == "--out")
+            {
+                outFile = value;
+            }
+            else if (arg == "--min-time")
+            {
+                runner.min_sample_time = std::chrono::milliseconds{ parse_integer(arg, value, 0) };
+            }
+            else if (arg == "--repetitions")
+            {
+                runner.repetitions = static_cast<std::size_t>(parse_integer(arg, value, 1));
+            }
+            else
+            {
+                throw std::invalid_argument("Unknown argument: " + arg);
+            }
+        }
+    }
+    catch (const std::invalid_argument& error)
+    {
+        std::cerr << error.what() << "\n" << usage;
+        return 1;
+    }
+
+    // Opened up front, so an unwritable path fails before running any benchmark
+    std::ofstream outStream;
+    if (!outFile.empty())
+    {
+        outStream.open(outFile);
+        if (!outStream)
+        {
+            std::cerr << "Can't open output file: " << outFile << "\n";
+            return 1;
+        }
+    }
+
+    runner.on_progress([](const bench::result& res) {
+        std::cerr << res.name;
+        for (const auto& p : res.params)
+        {
+            std::cerr << "/" << p.name << ":" << p.value;
+        }
+        std::cerr << "\t" << res.median_ns << " ns/op\t" << res.median_ns / res.items_per_op << " ns/item\n";
+    });
+
+    bench::run_pipeable_benchmarks(runner);
+    bench::run_data_generator_benchmarks(runner);
+    bench::run_guarded_data_generator_benchmarks(runner);
+    bench::run_data_source_benchmarks(runner);
+    bench::run_stage_registry_benchmarks(runner);
+
+    std::ostream& out = outFile.empty() ? std::cout : outStream;
+    runner.write_json(out, argv[0]);
+    out.flush();
+    if (!out)
+    {
+        std::cerr << "Failed writing results" << (outFile.empty() ? std::string() : " to " + outFile) << "\n";
+        return 1;
+    }
+    return 0;
+}
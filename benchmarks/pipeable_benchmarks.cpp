@@ -0,0 +1,174 @@
+#include "benchmark.hpp"
+
+#include <pipeable/pipeable.hpp>
+#include <pipeable/any_pipe.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <utility>
+
+using namespace pipeable;
+
+namespace
+{
+    // Cheap, non-foldable stage: the optimizer can't merge consecutive stages into a single operation
+    struct mix
+    {
+        std::uint64_t operator()(std::uint64_t val) const
+        {
+            return (val ^ (val >> 7)) * 0x9E3779B97F4A7C15ull;
+        }
+    };
+
+    template<std::size_t... indexes>
+    auto make_pipe(std::index_sequence<indexes...>)
+    {
+        if constexpr (sizeof...(indexes) == 1)
+        {
+            return mix{};
+        }
+        else
+        {
+            return assembly::compose(((void)indexes, mix{})...);
+        }
+    }
+
+    template<std::size_t stages>
+    std::uint64_t hand_written(std::uint64_t val)
+    {
+        if constexpr (stages == 0)
+        {
+            return val;
+        }
+        else
+        {
+            return mix{}(hand_written<stages - 1>(val));
+        }
+    }
+
+    template<std::size_t stages>
+    void run_chain(bench::runner& runner)
+    {
+        const std::vector<bench::param> params = { { "stages", std::int64_t(stages) } };
+
+        runner.run("pipe/hand_written", params, [](bench::state& state) {
+            std::uint64_t val = 1;
+            for (std::uint64_t i = 0; i < state.iterations(); ++i)
+            {
+                bench::launder(val);
+                val = hand_written<stages>(val);
+                bench::do_not_optimize(val);
+            }
+        });
+
+        runner.run("pipe/prebuilt_invoke", params, [](bench::state& state) {
+            auto pipe = make_pipe(std::make_index_sequence<stages>());
+            std::uint64_t val = 1;
+            for (std::uint64_t i = 0; i < state.iterations(); ++i)
+            {
+                bench::launder(val);
+                val = invocation::invoke(pipe, val);
+                bench::do_not_optimize(val);
+            }
+        });
+
+        runner.run("pipe/compose_and_invoke", params, [](bench::state& state) {
+            std::uint64_t val = 1;
+            for (std::uint64_t i = 0; i < state.iterations(); ++i)
+            {
+                bench::launder(val);
+                val = val >>= make_pipe(std::make_index_sequence<stages>());
+                bench::do_not_optimize(val);
+            }
+        });
+    }
+
+    using erased_t = any_pipe<std::uint64_t(std::uint64_t)>;
+
+    // One erased part per stage, merged into a single any_pipe
+    erased_t make_erased_chain(std::size_t stages)
+    {
+        erased_t chain = mix{};
+        for (std::size_t i = 1; i < stages; ++i)
+        {
+            chain = std::move(chain) >>= erased_t(mix{});
+        }
+        return chain;
+    }
+
+    // One erased part per stage, each wrapping the previous ones (as when composing std::functions)
+    std::function<std::uint64_t(std::uint64_t)> make_nested_functions(std::size_t stages)
+    {
+        std::function<std::uint64_t(std::uint64_t)> chain = mix{};
+        for (std::size_t i = 1; i < stages; ++i)
+        {
+            chain = std::function<std::uint64_t(std::uint64_t)>(assembly::compose(std::move(chain), mix{}));
+        }
+        return chain;
+    }
+
+    template<std::size_t stages>
+    void run_erased_chain(bench::runner& runner)
+    {
+        const std::vector<bench::param> params = { { "stages", std::int64_t(stages) } };
+
+        runner.run("pipe/std_function", params, [](bench::state& state) {
+            std::function<std::uint64_t(std::uint64_t)> pipe = make_pipe(std::make_index_sequence<stages>());
+            std::uint64_t val = 1;
+            for (std::uint64_t i = 0; i < state.iterations(); ++i)
+            {
+                bench::launder(val);
+                val = pipe(val);
+                bench::do_not_optimize(val);
+            }
+        });
+
+        runner.run("pipe/any_pipe", params, [](bench::state& state) {
+            erased_t pipe = make_pipe(std::make_index_sequence<stages>());
+            std::uint64_t val = 1;
+            for (std::uint64_t i = 0; i < state.iterations(); ++i)
+            {
+                bench::launder(val);
+                val = pipe(val);
+                bench::do_not_optimize(val);
+            }
+        });
+
+        runner.run("pipe/nested_std_functions", params, [](bench::state& state) {
+            auto pipe = make_nested_functions(stages);
+            std::uint64_t val = 1;
+            for (std::uint64_t i = 0; i < state.iterations(); ++i)
+            {
+                bench::launder(val);
+                val = pipe(val);
+                bench::do_not_optimize(val);
+            }
+        });
+
+        runner.run("pipe/merged_any_pipes", params, [](bench::state& state) {
+            auto pipe = make_erased_chain(stages);
+            std::uint64_t val = 1;
+            for (std::uint64_t i = 0; i < state.iterations(); ++i)
+            {
+                bench::launder(val);
+                val = pipe(val);
+                bench::do_not_optimize(val);
+            }
+        });
+    }
+
+    template<std::size_t... stages>
+    void run_chains(bench::runner& runner)
+    {
+        (run_chain<stages>(runner), ...);
+        (run_erased_chain<stages>(runner), ...);
+    }
+}
+
+namespace pipeable::bench
+{
+    void run_pipeable_benchmarks(runner& runner)
+    {
+        run_chains<1, 2, 4, 8, 16, 32>(runner);
+    }
+}
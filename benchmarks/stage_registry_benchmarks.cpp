@@ -0,0 +1,87 @@
+#include "benchmark.hpp"
+
+#include <pipeable/pipeable.hpp>
+#include <pipeable/stage_registry.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace pipeable;
+
+namespace
+{
+    // Cheap, non-foldable stage
+    struct mix
+    {
+        std::uint64_t operator()(std::uint64_t val) const
+        {
+            return (val ^ (val >> 7)) * 0x9E3779B97F4A7C15ull;
+        }
+    };
+
+    constexpr std::int64_t batch_sizes[] = { 16, 256, 1024 };
+
+    void run_batches(bench::runner& runner, std::int64_t batchSize)
+    {
+        const std::vector<bench::param> params = { { "stages", std::int64_t(4) }, { "batch", batchSize } };
+
+        runner.run("stage_registry/compile_time_pipe", params, [batchSize](bench::state& state) {
+            const auto pipe = mix{} >>= mix{} >>= mix{} >>= mix{};
+            std::vector<std::uint64_t> values(batchSize, 1), output(batchSize);
+            for (std::uint64_t i = 0; i < state.iterations(); ++i)
+            {
+                values.front() = i;
+                bench::launder(values);
+                for (std::size_t j = 0; j < values.size(); ++j)
+                {
+                    output[j] = values[j] >>= pipe;
+                }
+                bench::do_not_optimize(output.back());
+            }
+            state.set_items_per_op(double(batchSize));
+        });
+
+        runner.run("stage_registry/runtime_pipe", params, [batchSize](bench::state& state) {
+            stage_registry registry;
+            registry.add<std::uint64_t>("mix", [](const stage_registry::args_t&) { return mix{}; });
+            auto pipe = registry.build<std::uint64_t, std::uint64_t>("mix >>= mix >>= mix >>= mix");
+            std::vector<std::uint64_t> values(batchSize, 1);
+            for (std::uint64_t i = 0; i < state.iterations(); ++i)
+            {
+                values.front() = i;
+                bench::launder(values);
+                const auto output = pipe(values);
+                bench::do_not_optimize(output.back());
+            }
+            state.set_items_per_op(double(batchSize));
+        });
+
+        // Stages registered as a single compile time pipe: one virtual call per batch
+        runner.run("stage_registry/runtime_pipe_fused", params, [batchSize](bench::state& state) {
+            stage_registry registry;
+            registry.add<std::uint64_t>("mix4", [](const stage_registry::args_t&) { return mix{} >>= mix{} >>= mix{} >>= mix{}; });
+            auto pipe = registry.build<std::uint64_t, std::uint64_t>("mix4");
+            std::vector<std::uint64_t> values(batchSize, 1);
+            for (std::uint64_t i = 0; i < state.iterations(); ++i)
+            {
+                values.front() = i;
+                bench::launder(values);
+                const auto output = pipe(values);
+                bench::do_not_optimize(output.back());
+            }
+            state.set_items_per_op(double(batchSize));
+        });
+    }
+}
+
+namespace pipeable::bench
+{
+    void run_stage_registry_benchmarks(runner& runner)
+    {
+        for (const auto batchSize : batch_sizes)
+        {
+            run_batches(runner, batchSize);
+        }
+    }
+}
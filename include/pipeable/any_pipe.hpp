@@ -0,0 +1,382 @@
+#pragma once
+
+#include <pipeable/pipeable.hpp>
+#include <cstddef>
+#include <new>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Max size (bytes) of callables (eg. whole pipes) stored inline (without allocation) by any_pipe
+#ifndef PIPEABLE_ANY_PIPE_INLINE_CAPACITY
+#define PIPEABLE_ANY_PIPE_INLINE_CAPACITY (4 * sizeof(void*))
+#endif
+
+namespace pipeable
+{
+    template<typename signature_t, std::size_t inline_capacity = PIPEABLE_ANY_PIPE_INLINE_CAPACITY>
+    class any_pipe;
+
+    namespace impl
+    {
+        template<typename callable_t, typename... args_t>
+        constexpr decltype(auto) invoke_erased(callable_t& callable, args_t&&... args)
+        {
+            if constexpr (meta::is_pipe_v<callable_t>)
+            {
+                return invocation::invoke(callable, FWD(args)...);
+            }
+            else
+            {
+                return meta::deref_if_ptr(callable)(FWD(args)...);
+            }
+        }
+
+        // Whether a result of type 'result_t' can be returned as 'return_t'.
+        // A reference is only returned if the result refers to an existing object (never to a temporary).
+        template<typename result_t, typename return_t>
+        constexpr bool is_returnable_as()
+        {
+            if constexpr (std::is_void_v<return_t>)
+            {
+                return true;
+            }
+            else if constexpr (std::is_reference_v<return_t>)
+            {
+                return std::is_reference_v<result_t>
+                    && (std::is_lvalue_reference_v<return_t> || std::is_rvalue_reference_v<result_t>)
+                    && std::is_convertible_v<std::remove_reference_t<result_t>*, std::remove_reference_t<return_t>*>;
+            }
+            else
+            {
+                return std::is_convertible_v<result_t, return_t>;
+            }
+        }
+
+        // Like a single callable, a pipe is invocable if its head is (with all arguments)
+        template<typename pipe_t, typename... args_t>
+        constexpr bool is_pipe_invocable()
+        {
+            if constexpr (sizeof...(args_t) <= 1)
+            {
+                return meta::is_invocable_v<pipe_t, args_t...>;
+            }
+            else
+            {
+                return meta::details::is_head_invocable<typename pipe_t::head_t, args_t...>();
+            }
+        }
+
+        template<typename callable_t, typename return_t, typename... args_t>
+        constexpr bool is_erasable_as()
+        {
+            if constexpr (meta::is_pipe_v<callable_t>)
+            {
+                if constexpr (is_pipe_invocable<callable_t, args_t...>())
+                {
+                    return is_returnable_as<decltype(invocation::invoke(std::declval<callable_t&>(), std::declval<args_t>()...)), return_t>();
+                }
+                else
+                {
+                    return false;
+                }
+            }
+            else if constexpr (std::is_invocable_v<meta::referenced_t<callable_t>&, args_t...>)
+            {
+                return is_returnable_as<std::invoke_result_t<meta::referenced_t<callable_t>&, args_t...>, return_t>();
+            }
+            else
+            {
+                return false;
+            }
+        }
+
+        /*
+        A single erased callable of an any_pipe (move-only, small-buffer storage).
+        Invoked with its arguments, it passes its result on to the next segment (as its argument),
+        or (if last) stores it as the result of the whole any_pipe. So a chain of segments is invoked
+        with one indirect (tail) call per segment, however it was composed.
+        */
+        template<std::size_t inline_capacity>
+        class pipe_segment
+        {
+            enum class operation { move, destroy };
+
+            // Erased 'call_t<args_t...>' (cast back when invoked with 'args_t...')
+            using erased_call_t = void(*)();
+            template<typename... args_t>
+            using call_t = void(*)(const pipe_segment&, void* result, args_t...);
+            using manage_t = void(*)(operation, pipe_segment& dst, pipe_segment* src);
+
+            template<typename callable_t>
+            static constexpr bool is_inline_v =
+                sizeof(callable_t) <= inline_capacity &&
+                alignof(callable_t) <= alignof(std::max_align_t) &&
+                std::is_nothrow_move_constructible_v<callable_t>;
+
+        public:
+            pipe_segment() = default;
+
+            // Segment of 'callable' invoked as 'return_t(args_t...)'
+            template<typename return_t, typename... args_t, typename callable_t>
+            static pipe_segment make(callable_t&& callable)
+            {
+                using decayed_t = std::decay_t<callable_t>;
+                pipe_segment segment;
+                if constexpr (is_inline_v<decayed_t>)
+                {
+                    ::new (static_cast<void*>(&segment.storage_)) decayed_t(FWD(callable));
+                }
+                else
+                {
+                    ::new (static_cast<void*>(&segment.storage_)) decayed_t*(new decayed_t(FWD(callable)));
+                }
+                segment.callLast_ = reinterpret_cast<erased_call_t>(&call_last<decayed_t, return_t, args_t...>);
+                segment.callNext_ = reinterpret_cast<erased_call_t>(&call_next<decayed_t, return_t, args_t...>);
+                segment.call_ = segment.callLast_;
+                segment.manage_ = &manage<decayed_t>;
+                return segment;
+            }
+
+            pipe_segment(pipe_segment&& other) noexcept :
+                call_(other.call_),
+                callLast_(other.callLast_),
+                callNext_(other.callNext_),
+                manage_(other.manage_),
+                next_(other.next_)
+            {
+                if (manage_)
+                {
+                    manage_(operation::move, *this, &other);
+                }
+            }
+
+            pipe_segment& operator=(pipe_segment&& other) noexcept
+            {
+                if (this != &other)
+                {
+                    this->~pipe_segment();
+                    ::new (static_cast<void*>(this)) pipe_segment(std::move(other));
+                }
+                return *this;
+            }
+
+            ~pipe_segment()
+            {
+                if (manage_)
+                {
+                    manage_(operation::destroy, *this, nullptr);
+                }
+            }
+
+            // 'args_t' must be the exact argument types the segment was made with
+            template<typename... args_t>
+            void invoke(void* result, args_t... args) const
+            {
+                reinterpret_cast<call_t<args_t...>>(call_)(*this, result, std::forward<args_t>(args)...);
+            }
+
+            explicit operator bool() const
+            {
+                return call_ != nullptr;
+            }
+
+            void link(const pipe_segment* next)
+            {
+                next_ = next;
+                call_ = next ? callNext_ : callLast_;
+            }
+
+        private:
+            template<typename callable_t>
+            callable_t& get() const
+            {
+                auto storage = const_cast<void*>(static_cast<const void*>(&storage_));
+                if constexpr (is_inline_v<callable_t>)
+                {
+                    return *std::launder(static_cast<callable_t*>(storage));
+                }
+                else
+                {
+                    return **static_cast<callable_t**>(storage);
+                }
+            }
+
+            // Last segment: store result (value in an optional, or address of reference)
+            template<typename callable_t, typename return_t, typename... args_t>
+            static void call_last(const pipe_segment& self, void* result, args_t... args)
+            {
+                if constexpr (std::is_void_v<return_t>)
+                {
+                    invoke_erased(self.get<callable_t>(), std::forward<args_t>(args)...);
+                }
+                else if constexpr (std::is_reference_v<return_t>)
+                {
+                    // Result is a reference to an object outliving the call (see is_returnable_as), never converted to a temporary
+                    auto&& value = invoke_erased(self.get<callable_t>(), std::forward<args_t>(args)...);
+                    *static_cast<std::remove_reference_t<return_t>**>(result) = std::addressof(value);
+                }
+                else
+                {
+                    static_cast<std::optional<return_t>*>(result)->emplace(invoke_erased(self.get<callable_t>(), std::forward<args_t>(args)...));
+                }
+            }
+
+            // Pass result on to next segment (composition requires a non void result)
+            template<typename callable_t, typename return_t, typename... args_t>
+            static void call_next(const pipe_segment& self, void* result, args_t... args)
+            {
+                if constexpr (!std::is_void_v<return_t>)
+                {
+                    self.next_->template invoke<return_t>(result, invoke_erased(self.get<callable_t>(), std::forward<args_t>(args)...));
+                }
+            }
+
+            template<typename callable_t>
+            static void manage(operation op, pipe_segment& dst, pipe_segment* src)
+            {
+                if constexpr (is_inline_v<callable_t>)
+                {
+                    switch (op)
+                    {
+                    case operation::move:
+                        ::new (static_cast<void*>(&dst.storage_)) callable_t(std::move(src->get<callable_t>()));
+                        break;
+                    case operation::destroy:
+                        dst.get<callable_t>().~callable_t();
+                        break;
+                    }
+                }
+                else
+                {
+                    auto& dstPtr = *reinterpret_cast<callable_t**>(&dst.storage_);
+                    switch (op)
+                    {
+                    case operation::move:
+                        // Steal allocation, and leave source empty
+                        dstPtr = *reinterpret_cast<callable_t**>(&src->storage_);
+                        src->call_ = src->callLast_ = src->callNext_ = nullptr;
+                        src->manage_ = nullptr;
+                        break;
+                    case operation::destroy:
+                        delete dstPtr;
+                        break;
+                    }
+                }
+            }
+
+            std::aligned_storage_t<(inline_capacity < sizeof(void*) ? sizeof(void*) : inline_capacity), alignof(std::max_align_t)> storage_{};
+            erased_call_t call_ = nullptr;
+            erased_call_t callLast_ = nullptr;
+            erased_call_t callNext_ = nullptr;
+            manage_t manage_ = nullptr;
+            const pipe_segment* next_ = nullptr;
+        };
+    }
+
+    /*
+    Move-only type-erased pipe (or any callable), invocable as 'return_t(args_t...)'.
+    A whole composite_pipe is erased as a single callable: its stages are invoked (and inlined) as usual, behind a single indirect call.
+    Callables fitting 'inline_capacity' (and nothrow movable) are stored inline without allocation.
+    Composing two any_pipes (as r-values) with '>>=' merges them into one any_pipe, invoking each erased part in turn (never nested),
+    eg. 'any_pipe<std::string(int)> pipeline = std::move(parse) >>= std::move(format);'. That's still one indirect call per part
+    (erased parts can't be fused): compose pipes before erasing them for a single indirect call.
+    Invoking an empty any_pipe is undefined.
+    */
+    template<typename return_t, typename... args_t, std::size_t inline_capacity>
+    class any_pipe<return_t(args_t...), inline_capacity> : impl::pipe_holder_tag
+    {
+        using segment_t = impl::pipe_segment<inline_capacity>;
+
+        template<typename head_return_t, typename... head_args_t, typename tail_return_t, std::size_t capacity>
+        friend any_pipe<tail_return_t(head_args_t...), capacity> operator>>=(
+            any_pipe<head_return_t(head_args_t...), capacity>&& head, any_pipe<tail_return_t(head_return_t), capacity>&& tail);
+
+    public:
+        static constexpr std::size_t capacity = inline_capacity;
+
+        any_pipe() = default;
+
+        template<typename callable_t, typename decayed_t = std::decay_t<callable_t>,
+            typename = std::enable_if_t<!std::is_same_v<decayed_t, any_pipe> && impl::is_erasable_as<decayed_t, return_t, args_t...>()>>
+        any_pipe(callable_t&& callable) :
+            head_(segment_t::template make<return_t, args_t...>(FWD(callable)))
+        {
+        }
+
+        any_pipe(any_pipe&&) noexcept = default;
+        any_pipe& operator=(any_pipe&&) noexcept = default;
+
+        return_t operator()(args_t... args) const
+        {
+            if constexpr (std::is_void_v<return_t>)
+            {
+                head_.template invoke<args_t...>(nullptr, std::forward<args_t>(args)...);
+            }
+            else if constexpr (std::is_reference_v<return_t>)
+            {
+                std::remove_reference_t<return_t>* result = nullptr;
+                head_.template invoke<args_t...>(&result, std::forward<args_t>(args)...);
+                return static_cast<return_t>(*result);
+            }
+            else
+            {
+                std::optional<return_t> result;
+                head_.template invoke<args_t...>(&result, std::forward<args_t>(args)...);
+                return std::move(*result);
+            }
+        }
+
+        explicit operator bool() const
+        {
+            return static_cast<bool>(head_);
+        }
+
+        // Number of erased callables invoked in turn (each one indirect call)
+        std::size_t segments() const
+        {
+            return head_ ? 1 + tail_.size() : 0;
+        }
+
+    private:
+        void link()
+        {
+            head_.link(tail_.empty() ? nullptr : tail_.data());
+            for (std::size_t i = 0; i < tail_.size(); ++i)
+            {
+                tail_[i].link(i + 1 < tail_.size() ? &tail_[i + 1] : nullptr);
+            }
+        }
+
+        segment_t head_;
+        // Segments following head (allocated only when composed)
+        std::vector<segment_t> tail_;
+    };
+
+    // Merge 'head' & 'tail' into one any_pipe: the segments of 'tail' are invoked with the result of the last segment of 'head'
+    template<typename head_return_t, typename... head_args_t, typename tail_return_t, std::size_t capacity>
+    any_pipe<tail_return_t(head_args_t...), capacity> operator>>=(
+        any_pipe<head_return_t(head_args_t...), capacity>&& head, any_pipe<tail_return_t(head_return_t), capacity>&& tail)
+    {
+        static_assert(!std::is_void_v<head_return_t>, "any_pipe: can't compose with a pipe returning void.");
+        any_pipe<tail_return_t(head_args_t...), capacity> composed;
+        composed.tail_.reserve(head.tail_.size() + 1 + tail.tail_.size());
+        composed.head_ = std::move(head.head_);
+        for (auto& segment : head.tail_)
+        {
+            composed.tail_.push_back(std::move(segment));
+        }
+        composed.tail_.push_back(std::move(tail.head_));
+        for (auto& segment : tail.tail_)
+        {
+            composed.tail_.push_back(std::move(segment));
+        }
+        // Leave both empty
+        head = {};
+        tail = {};
+        composed.link();
+        return composed;
+    }
+}
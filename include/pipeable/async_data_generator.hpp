@@ -0,0 +1,363 @@
+#pragma once
+
+#include <pipeable/backpressure.hpp>
+#include <pipeable/guarded_data_generator.hpp>
+#include <pipeable/thread_pool.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <variant>
+
+namespace pipeable
+{
+    struct async_receiver_metrics
+    {
+        std::size_t queue_depth = 0;        // Values currently queued
+        std::size_t max_queue_depth = 0;    // Deepest queue observed when a drain started
+        std::uint64_t delivered = 0;        // Values passed to the receiver
+        std::uint64_t failed = 0;           // Deliveries where the receiver threw (the exception is dropped, draining goes on)
+        std::chrono::nanoseconds last_drain_latency{};  // From a drain being scheduled until the queue was emptied
+        std::chrono::nanoseconds max_drain_latency{};
+        backpressure_metrics backpressure;  // Values dropped, coalesced or spilled by a full queue
+    };
+
+    namespace impl
+    {
+        // Count of scheduled (or running) drains of one generator's receivers: waited on instead of the (possibly shared) pool
+        class async_drains
+        {
+        public:
+            void begin()
+            {
+                pending_.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            void end()
+            {
+                if (pending_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                {
+                    std::scoped_lock lock{ mutex_ };
+                    idle_.notify_all();
+                }
+            }
+
+            void wait_idle()
+            {
+                std::unique_lock lock{ mutex_ };
+                idle_.wait(lock, [this] { return pending_.load(std::memory_order_acquire) == 0; });
+            }
+
+        private:
+            std::atomic<std::size_t> pending_{ 0 };
+            std::mutex mutex_;
+            std::condition_variable idle_;
+        };
+
+        struct async_receiver_state_base
+        {
+            virtual ~async_receiver_state_base() = default;
+            virtual async_receiver_metrics metrics() const = 0;
+        };
+
+        /*
+        Bounded queue of values for one receiver, drained (by at most one task at a time) on a thread pool.
+        Values of all output types share the queue, so the receiver observes them in emission order.
+        */
+        template<typename policy_t, typename callable_t, typename... outputs_t>
+        class async_receiver_state final : public async_receiver_state_base, public std::enable_shared_from_this<async_receiver_state<policy_t, callable_t, outputs_t...>>
+        {
+            template<std::size_t index>
+            using output_t = std::tuple_element_t<index, std::tuple<outputs_t...>>;
+
+            // Single output: the plain value, else variant of all (alternative index == output index)
+            using item_t = std::conditional_t<sizeof...(outputs_t) == 1,
+                std::remove_cv_t<std::remove_reference_t<output_t<0>>>,
+                std::variant<std::remove_cv_t<std::remove_reference_t<outputs_t>>...>>;
+
+            using clock_t = std::chrono::steady_clock;
+
+            static constexpr std::size_t drain_batch = 64;
+
+        public:
+            template<typename T>
+            async_receiver_state(T&& callable, thread_pool& pool, std::shared_ptr<async_drains> drains, std::size_t capacity, const policy_t& policy) :
+                callable_(std::forward<T>(callable)),
+                pool_(pool),
+                drains_(std::move(drains)),
+                queue_(capacity, policy)
+            {}
+
+            // Enqueue a copy of 'arg' (emitted as output type at 'index'). Applies the backpressure policy while the queue is full.
+            template<std::size_t index, typename arg_t>
+            void push(arg_t&& arg)
+            {
+                if (push_as<index>(std::forward<arg_t>(arg)))
+                {
+                    schedule();
+                }
+            }
+
+            async_receiver_metrics metrics() const override
+            {
+                async_receiver_metrics metrics;
+                metrics.queue_depth = queue_.size();
+                metrics.max_queue_depth = maxDepth_.load(std::memory_order_relaxed);
+                metrics.delivered = delivered_.load(std::memory_order_relaxed);
+                metrics.failed = failed_.load(std::memory_order_relaxed);
+                metrics.last_drain_latency = std::chrono::nanoseconds(lastLatency_.load(std::memory_order_relaxed));
+                metrics.max_drain_latency = std::chrono::nanoseconds(maxLatency_.load(std::memory_order_relaxed));
+                metrics.backpressure = queue_.metrics();
+                return metrics;
+            }
+
+        private:
+            template<std::size_t index, typename arg_t>
+            bool push_as(arg_t&& arg)
+            {
+                if constexpr (sizeof...(outputs_t) == 1)
+                {
+                    return queue_.push(std::forward<arg_t>(arg));
+                }
+                else
+                {
+                    return queue_.push(std::in_place_index<index>, std::forward<arg_t>(arg));
+                }
+            }
+
+            void schedule()
+            {
+                // Pairs with the fence in drain(): either we see the drain still scheduled, or it sees our value
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if (!scheduled_.load(std::memory_order_relaxed) && !scheduled_.exchange(true, std::memory_order_acq_rel))
+                {
+                    scheduledAt_ = clock_t::now();
+                    drains_->begin();
+                    try
+                    {
+                        pool_.submit([self = this->shared_from_this()] { self->drain(); });
+                    }
+                    catch (...)
+                    {
+                        scheduled_.store(false, std::memory_order_seq_cst);
+                        drains_->end();
+                        throw;
+                    }
+                }
+            }
+
+            // A throwing receiver can't fail the pool's worker (nor the emitter): its exception is counted and dropped
+            void drain()
+            {
+                // Released last (even if rescheduling throws), so the generator never observes no drains while values remain queued
+                struct release_t
+                {
+                    ~release_t()
+                    {
+                        drains.end();
+                    }
+
+                    async_drains& drains;
+                } release{ *drains_ };
+
+                const auto depth = queue_.size();
+                if (depth > maxDepth_.load(std::memory_order_relaxed))
+                {
+                    maxDepth_.store(depth, std::memory_order_relaxed);
+                }
+
+                std::uint64_t delivered = 0;
+                std::uint64_t failed = 0;
+                const auto deliverOne = [this, &failed](item_t&& item) {
+                    try
+                    {
+                        deliver(item);
+                    }
+                    catch (...)
+                    {
+                        ++failed;
+                    }
+                };
+                while (const auto popped = queue_.pop_batch(deliverOne, drain_batch))
+                {
+                    delivered += popped;
+                }
+                delivered_.store(delivered_.load(std::memory_order_relaxed) + delivered, std::memory_order_relaxed);
+                failed_.store(failed_.load(std::memory_order_relaxed) + failed, std::memory_order_relaxed);
+
+                const auto latency = std::chrono::duration_cast<std::chrono::nanoseconds>(clock_t::now() - scheduledAt_).count();
+                lastLatency_.store(latency, std::memory_order_relaxed);
+                if (latency > maxLatency_.load(std::memory_order_relaxed))
+                {
+                    maxLatency_.store(latency, std::memory_order_relaxed);
+                }
+
+                scheduled_.store(false, std::memory_order_seq_cst);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                // Values pushed after the queue was emptied, but before scheduled was cleared, are drained by a new task
+                if (!queue_.empty())
+                {
+                    schedule();
+                }
+            }
+
+            void deliver(item_t& item)
+            {
+                if constexpr (sizeof...(outputs_t) == 1)
+                {
+                    deliver_as<0>(item);
+                }
+                else
+                {
+                    deliver(item, std::index_sequence_for<outputs_t...>());
+                }
+            }
+
+            template<std::size_t... indexes>
+            void deliver(item_t& item, std::index_sequence<indexes...>)
+            {
+                ((item.index() == indexes ? deliver_as<indexes>(std::get<indexes>(item)) : void()), ...);
+            }
+
+            template<std::size_t index, typename value_t>
+            void deliver_as(value_t& value)
+            {
+                // Only output types the receiver is invocable with are ever queued
+                if constexpr (meta::is_invocable_v<callable_t, output_t<index>>)
+                {
+                    if constexpr (std::is_lvalue_reference_v<output_t<index>>)
+                    {
+                        invocation::invoke(callable_, value);
+                    }
+                    else
+                    {
+                        // Queued value is owned by this receiver only
+                        invocation::invoke(callable_, std::move(value));
+                    }
+                }
+            }
+
+            callable_t callable_;
+            thread_pool& pool_;
+            std::shared_ptr<async_drains> drains_;
+            // Many emitting threads, consumed by one drain at a time
+            backpressure_queue<item_t, policy_t, true, false> queue_;
+            std::atomic<bool> scheduled_{ false };
+            clock_t::time_point scheduledAt_;
+            std::atomic<std::size_t> maxDepth_{ 0 };
+            std::atomic<std::uint64_t> delivered_{ 0 };
+            std::atomic<std::uint64_t> failed_{ 0 };
+            std::atomic<std::int64_t> lastLatency_{ 0 };
+            std::atomic<std::int64_t> maxLatency_{ 0 };
+        };
+
+        // Registered on the generator in place of the receiver (one per matching output type): emitting only enqueues
+        template<std::size_t index, typename state_t, typename output_t>
+        struct async_dispatch
+        {
+            void operator()(output_t arg) const
+            {
+                using value_t = std::remove_reference_t<output_t>;
+                if constexpr (std::is_rvalue_reference_v<output_t> && std::is_copy_constructible_v<value_t>)
+                {
+                    // Every receiver is passed the same r-value: each queues a copy, so none is left with a moved-from value
+                    state->template push<index>(static_cast<const value_t&>(arg));
+                }
+                else
+                {
+                    state->template push<index>(std::forward<output_t>(arg));
+                }
+            }
+
+            std::shared_ptr<state_t> state;
+        };
+    }
+
+    // Handle to a registration on an async_data_generator, also exposing the metrics of the receivers' queue
+    template<typename... outputs_t>
+    struct async_subscription : subscription<outputs_t...>
+    {
+        async_receiver_metrics metrics() const
+        {
+            return state ? state->metrics() : async_receiver_metrics{};
+        }
+
+        std::shared_ptr<const impl::async_receiver_state_base> state;
+    };
+
+    /*
+    Thread safe data generator where each receiver is invoked asynchronously on a thread pool.
+    Emitting copies the value into a bounded (lock-free) queue per receiver, and schedules a drain of that queue if none is pending.
+    Each receiver is invoked by one thread at a time, in emission order. Receivers must outlive the generator (or be deregistered
+    and drained with 'wait_idle()'). An exception thrown by a receiver is counted in its metrics and dropped.
+    Non-const reference outputs are copied as well, so receivers can't modify the emitted value.
+    R-value outputs are copied too (one per receiver), unless move-only: then only a single receiver should be registered.
+    A full queue applies the backpressure policy (see backpressure.hpp), by default blocking the emitter until there is room.
+    */
+    template<typename policy_t, typename... outputs_t>
+    struct basic_async_data_generator : impl::multi_generator<impl::thread_safe, outputs_t...>
+    {
+        static constexpr std::size_t default_queue_capacity = 1024;
+
+        explicit basic_async_data_generator(std::size_t queueCapacity = default_queue_capacity, policy_t policy = {}) :
+            ownPool_(std::make_unique<thread_pool>()),
+            pool_(*ownPool_),
+            queueCapacity_(queueCapacity),
+            policy_(std::move(policy))
+        {}
+
+        explicit basic_async_data_generator(thread_pool& pool, std::size_t queueCapacity = default_queue_capacity, policy_t policy = {}) :
+            pool_(pool),
+            queueCapacity_(queueCapacity),
+            policy_(std::move(policy))
+        {}
+
+        ~basic_async_data_generator()
+        {
+            // Queued values reference receivers, so deliver them before receivers are torn down
+            wait_idle();
+        }
+
+        template<typename callable_t,
+            concepts::IsInvocableWithAny<callable_t, outputs_t...> = nullptr>
+        async_subscription<outputs_t...> operator+=(callable_t&& downstream)
+        {
+            using state_t = impl::async_receiver_state<policy_t, std::decay_t<callable_t>, outputs_t...>;
+            auto state = std::make_shared<state_t>(FWD(downstream), pool_, drains_, queueCapacity_, policy_);
+
+            async_subscription<outputs_t...> sub;
+            sub.state = state;
+            this->template for_each_matching_output<callable_t>([&](auto index) {
+                using dispatch_t = impl::async_dispatch<index, state_t, typename base_t::template output_t<index>>;
+                using output_base_t = typename base_t::template base_t<index>;
+                this->output_base_t::update([&](auto& tx) {
+                    sub.ids[index] = tx.insert(downstream, dispatch_t{ state });
+                });
+            });
+            return sub;
+        }
+
+        // Block until all values emitted so far have been delivered.
+        // Only waits on this generator's receivers (not other work of the pool), which require a free worker of the pool.
+        void wait_idle()
+        {
+            drains_->wait_idle();
+        }
+
+    private:
+        using base_t = impl::multi_generator<impl::thread_safe, outputs_t...>;
+
+        std::unique_ptr<thread_pool> ownPool_;
+        thread_pool& pool_;
+        // Shared with receivers, as a drain may still signal it while the generator is destroyed
+        std::shared_ptr<impl::async_drains> drains_ = std::make_shared<impl::async_drains>();
+        std::size_t queueCapacity_;
+        policy_t policy_;
+    };
+
+    template<typename... outputs_t>
+    using async_data_generator = basic_async_data_generator<backpressure::block, outputs_t...>;
+}
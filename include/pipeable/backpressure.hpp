@@ -0,0 +1,549 @@
+#pragma once
+
+#include <pipeable/internal/mpsc_queue.hpp>
+#include <pipeable/internal/ring_buffer.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+
+namespace pipeable
+{
+    // What a bounded queue does with a value pushed while it's full
+    namespace backpressure
+    {
+        // Producer waits (yields) until there is room
+        struct block {};
+
+        // Value pushed is discarded
+        struct drop_newest {};
+
+        // Oldest queued value is discarded to make room
+        struct drop_oldest {};
+
+        // A queued value with the same key ('key(value)', hashable) is replaced by the one pushed, keeping its position.
+        // Values with distinct keys are always queued (producer waits while as many keys as the capacity are queued).
+        template<typename key_fn_t>
+        struct coalesce
+        {
+            key_fn_t key;
+        };
+        template<typename key_fn_t>
+        coalesce(key_fn_t) -> coalesce<key_fn_t>;
+
+        // Overflowing values (trivially copyable only) are appended to a file, and read back in order once the queue drained.
+        // Without a path, an anonymous temporary file is used per queue. Else the file is 'path' suffixed by a unique number.
+        // The file is only created on the first spill (which throws if it can't be).
+        struct spill
+        {
+            std::string path;
+        };
+    }
+
+    struct backpressure_metrics
+    {
+        std::uint64_t dropped = 0;      // Values discarded (drop_newest, drop_oldest)
+        std::uint64_t coalesced = 0;    // Values replaced by a newer one with the same key
+        std::uint64_t spilled = 0;      // Values written to disk
+    };
+
+    namespace impl
+    {
+        template<typename T, bool multi_producer, bool multi_consumer>
+        using ring_for_t = std::conditional_t<!multi_consumer,
+            std::conditional_t<multi_producer, mpsc_queue<T>, spsc_ring<T>>,
+            mpmc_ring<T>>;
+
+        struct backpressure_counters
+        {
+            void add(std::atomic<std::uint64_t>& counter, std::uint64_t count = 1)
+            {
+                counter.fetch_add(count, std::memory_order_relaxed);
+            }
+
+            backpressure_metrics metrics() const
+            {
+                return { dropped.load(std::memory_order_relaxed), coalesced.load(std::memory_order_relaxed), spilled.load(std::memory_order_relaxed) };
+            }
+
+            std::atomic<std::uint64_t> dropped{ 0 };
+            std::atomic<std::uint64_t> coalesced{ 0 };
+            std::atomic<std::uint64_t> spilled{ 0 };
+        };
+
+        /*
+        Bounded queue applying a backpressure policy when full (ring based: block, drop_newest & drop_oldest).
+        push()/push_batch() apply the policy, try_push()/try_push_batch() only queue what fits right away.
+        Dropping the oldest value makes producers consume, so it's always backed by a multi-consumer ring.
+        */
+        template<typename T, typename policy_t, bool multi_producer, bool multi_consumer>
+        class backpressure_queue
+        {
+            static_assert(std::is_same_v<policy_t, backpressure::block> || std::is_same_v<policy_t, backpressure::drop_newest> || std::is_same_v<policy_t, backpressure::drop_oldest>,
+                "Unknown backpressure policy");
+
+            static constexpr bool drop_newest = std::is_same_v<policy_t, backpressure::drop_newest>;
+            static constexpr bool drop_oldest = std::is_same_v<policy_t, backpressure::drop_oldest>;
+
+        public:
+            explicit backpressure_queue(std::size_t capacity, policy_t = {}) :
+                ring_(capacity)
+            {}
+
+            // Returns false if the value was dropped
+            template<typename... args_t>
+            bool push(args_t&&... args)
+            {
+                // Arguments are only consumed once a value is constructed, so they may be passed again
+                while (!ring_.try_push(std::forward<args_t>(args)...))
+                {
+                    if constexpr (drop_newest)
+                    {
+                        counters_.add(counters_.dropped);
+                        return false;
+                    }
+                    else if constexpr (drop_oldest)
+                    {
+                        counters_.add(counters_.dropped, ring_.pop_batch([](T&&) {}, 1));
+                    }
+                    else
+                    {
+                        std::this_thread::yield();
+                    }
+                }
+                return true;
+            }
+
+            template<typename... args_t>
+            bool try_push(args_t&&... args)
+            {
+                return ring_.try_push(std::forward<args_t>(args)...);
+            }
+
+            void push_batch(const T* values, std::size_t count)
+            {
+                for (auto pushed = ring_.push_batch(values, count); pushed < count; pushed += ring_.push_batch(values + pushed, count - pushed))
+                {
+                    if constexpr (drop_newest)
+                    {
+                        counters_.add(counters_.dropped, count - pushed);
+                        return;
+                    }
+                    else if constexpr (drop_oldest)
+                    {
+                        counters_.add(counters_.dropped, ring_.pop_batch([](T&&) {}, count - pushed));
+                    }
+                    else
+                    {
+                        std::this_thread::yield();
+                    }
+                }
+            }
+
+            std::size_t try_push_batch(const T* values, std::size_t count)
+            {
+                return ring_.push_batch(values, count);
+            }
+
+            template<typename consumer_t>
+            std::size_t pop_batch(consumer_t&& consumer, std::size_t max)
+            {
+                return ring_.pop_batch(std::forward<consumer_t>(consumer), max);
+            }
+
+            bool empty() const
+            {
+                return ring_.empty();
+            }
+
+            // Approximate when producers/consumers are active
+            std::size_t size() const
+            {
+                return ring_.size();
+            }
+
+            std::size_t capacity() const
+            {
+                return ring_.capacity();
+            }
+
+            backpressure_metrics metrics() const
+            {
+                return counters_.metrics();
+            }
+
+        private:
+            ring_for_t<T, multi_producer, multi_consumer || drop_oldest> ring_;
+            backpressure_counters counters_;
+        };
+
+        /*
+        Latest value per key, in order of first insertion (of a key not already queued).
+        Replacing a queued value requires a lookup by key, so (unlike ring based queues) it's guarded by a mutex.
+        */
+        template<typename T, typename key_fn_t, bool multi_producer, bool multi_consumer>
+        class backpressure_queue<T, backpressure::coalesce<key_fn_t>, multi_producer, multi_consumer>
+        {
+            using key_t = std::decay_t<std::invoke_result_t<const key_fn_t&, const T&>>;
+
+        public:
+            explicit backpressure_queue(std::size_t capacity, backpressure::coalesce<key_fn_t> policy) :
+                capacity_(capacity < 1 ? 1 : capacity),
+                key_(std::move(policy.key))
+            {}
+
+            template<typename... args_t>
+            bool push(args_t&&... args)
+            {
+                T value(std::forward<args_t>(args)...);
+                while (!try_insert(value))
+                {
+                    std::this_thread::yield();
+                }
+                return true;
+            }
+
+            // Returns false if the key isn't queued, and no more keys fit
+            template<typename... args_t>
+            bool try_push(args_t&&... args)
+            {
+                T value(std::forward<args_t>(args)...);
+                return try_insert(value);
+            }
+
+            void push_batch(const T* values, std::size_t count)
+            {
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    push(values[i]);
+                }
+            }
+
+            std::size_t try_push_batch(const T* values, std::size_t count)
+            {
+                std::size_t pushed = 0;
+                while (pushed < count && try_push(values[pushed]))
+                {
+                    ++pushed;
+                }
+                return pushed;
+            }
+
+            // Values are handed out one at a time (outside the lock)
+            template<typename consumer_t>
+            std::size_t pop_batch(consumer_t&& consumer, std::size_t max)
+            {
+                std::size_t popped = 0;
+                for (; popped < max; ++popped)
+                {
+                    std::unique_lock lock{ mutex_ };
+                    if (order_.empty())
+                    {
+                        break;
+                    }
+                    auto node = latest_.extract(order_.front());
+                    order_.pop_front();
+                    size_.store(latest_.size(), std::memory_order_release);
+                    lock.unlock();
+                    consumer(std::move(node.mapped()));
+                }
+                return popped;
+            }
+
+            bool empty() const
+            {
+                return size_.load(std::memory_order_seq_cst) == 0;
+            }
+
+            std::size_t size() const
+            {
+                return size_.load(std::memory_order_relaxed);
+            }
+
+            std::size_t capacity() const
+            {
+                return capacity_;
+            }
+
+            backpressure_metrics metrics() const
+            {
+                return counters_.metrics();
+            }
+
+        private:
+            // 'value' is only moved from if queued
+            bool try_insert(T& value)
+            {
+                auto key = std::invoke(key_, std::as_const(value));
+                std::scoped_lock lock{ mutex_ };
+                if (auto queued = latest_.find(key); queued != latest_.end())
+                {
+                    queued->second = std::move(value);
+                    counters_.add(counters_.coalesced);
+                    return true;
+                }
+                if (latest_.size() >= capacity_)
+                {
+                    return false;
+                }
+                latest_.emplace(key, std::move(value));
+                order_.push_back(std::move(key));
+                size_.store(latest_.size(), std::memory_order_release);
+                return true;
+            }
+
+            const std::size_t capacity_;
+            key_fn_t key_;
+            std::mutex mutex_;
+            std::unordered_map<key_t, T> latest_;
+            std::deque<key_t> order_;
+            std::atomic<std::size_t> size_{ 0 };
+            backpressure_counters counters_;
+        };
+
+        // Seek to a 64 bit offset ('long' is 32 bit on LLP64, and fseek would truncate offsets above 2 GiB)
+        inline void seek_file(std::FILE* file, std::uint64_t offset)
+        {
+#if defined(_WIN32)
+            using offset_t = __int64;
+#else
+            using offset_t = off_t;
+#endif
+            if (offset > std::uint64_t(std::numeric_limits<offset_t>::max()))
+            {
+                throw std::runtime_error("Spill file offset out of range");
+            }
+#if defined(_WIN32)
+            const auto result = _fseeki64(file, offset_t(offset), SEEK_SET);
+#else
+            const auto result = fseeko(file, offset_t(offset), SEEK_SET);
+#endif
+            if (result != 0)
+            {
+                throw std::runtime_error("Failed to seek spill file");
+            }
+        }
+
+        // Append-only file of trivially copyable values, read back in order (not thread safe). Opened on first append.
+        template<typename T>
+        class spill_file
+        {
+            static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable values can be spilled to disk");
+
+        public:
+            explicit spill_file(std::string path) :
+                path_(std::move(path))
+            {}
+
+            spill_file(const spill_file&) = delete;
+            spill_file& operator=(const spill_file&) = delete;
+
+            ~spill_file()
+            {
+                if (file_)
+                {
+                    std::fclose(file_);
+                    if (!path_.empty())
+                    {
+                        std::remove(path_.c_str());
+                    }
+                }
+            }
+
+            void append(const T* values, std::size_t count)
+            {
+                if (!file_)
+                {
+                    open();
+                }
+                seek_file(file_, written_ * sizeof(T));
+                if (std::fwrite(values, sizeof(T), count, file_) != count)
+                {
+                    throw std::runtime_error("Failed to write spill file");
+                }
+                written_ += count;
+            }
+
+            // Read up to 'max' values into 'values', returns count read
+            std::size_t read(T* values, std::size_t max)
+            {
+                const auto count = std::size_t(std::min<std::uint64_t>(max, written_ - read_));
+                if (count == 0)
+                {
+                    return 0;
+                }
+                seek_file(file_, read_ * sizeof(T));
+                if (std::fread(values, sizeof(T), count, file_) != count)
+                {
+                    throw std::runtime_error("Failed to read spill file");
+                }
+                read_ += count;
+                if (read_ == written_)
+                {
+                    // Drained, start over (file is reused without truncating)
+                    read_ = written_ = 0;
+                }
+                return count;
+            }
+
+        private:
+            void open()
+            {
+                static std::atomic<std::uint64_t> counter{ 0 };
+                if (path_.empty())
+                {
+                    file_ = std::tmpfile();
+                }
+                else
+                {
+                    auto path = path_ + "." + std::to_string(counter.fetch_add(1, std::memory_order_relaxed));
+                    file_ = std::fopen(path.c_str(), "w+b");
+                    if (!file_)
+                    {
+                        throw std::runtime_error("Failed to open spill file '" + path + "'");
+                    }
+                    path_ = std::move(path);
+                }
+                if (!file_)
+                {
+                    throw std::runtime_error("Failed to open spill file");
+                }
+            }
+
+            std::FILE* file_ = nullptr;
+            // Prefix until opened, then path of the file (empty for a temporary file)
+            std::string path_;
+            // Offsets in values: 64 bit even where size_t isn't
+            std::uint64_t written_ = 0;
+            std::uint64_t read_ = 0;
+        };
+
+        /*
+        Ring backed queue overflowing to a spill file. Once anything is spilled, values are appended to the file
+        until consumers (finding the ring empty) have read it all back, so values of one producer stay in order.
+        Only the overflow path takes a lock (around file access).
+        */
+        template<typename T, bool multi_producer, bool multi_consumer>
+        class backpressure_queue<T, backpressure::spill, multi_producer, multi_consumer>
+        {
+            static constexpr std::size_t read_chunk = 64;
+
+        public:
+            explicit backpressure_queue(std::size_t capacity, backpressure::spill policy = {}) :
+                ring_(capacity),
+                file_(policy.path)
+            {}
+
+            template<typename... args_t>
+            bool push(args_t&&... args)
+            {
+                if (try_push(std::forward<args_t>(args)...))
+                {
+                    return true;
+                }
+                const T value(std::forward<args_t>(args)...);
+                spill(&value, 1);
+                return true;
+            }
+
+            template<typename... args_t>
+            bool try_push(args_t&&... args)
+            {
+                return pending_.load(std::memory_order_acquire) == 0 && ring_.try_push(std::forward<args_t>(args)...);
+            }
+
+            void push_batch(const T* values, std::size_t count)
+            {
+                const auto pushed = try_push_batch(values, count);
+                if (pushed < count)
+                {
+                    spill(values + pushed, count - pushed);
+                }
+            }
+
+            std::size_t try_push_batch(const T* values, std::size_t count)
+            {
+                return pending_.load(std::memory_order_acquire) == 0 ? ring_.push_batch(values, count) : 0;
+            }
+
+            template<typename consumer_t>
+            std::size_t pop_batch(consumer_t&& consumer, std::size_t max)
+            {
+                if (auto popped = ring_.pop_batch(consumer, max); popped || pending_.load(std::memory_order_acquire) == 0)
+                {
+                    return popped;
+                }
+
+                std::aligned_storage_t<sizeof(T), alignof(T)> storage[read_chunk];
+                auto values = reinterpret_cast<T*>(storage);
+                std::size_t count;
+                {
+                    std::scoped_lock lock{ mutex_ };
+                    count = file_.read(values, std::min(max, read_chunk));
+                    pending_.fetch_sub(count, std::memory_order_release);
+                }
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    consumer(std::move(*std::launder(values + i)));
+                }
+                return count;
+            }
+
+            bool empty() const
+            {
+                return ring_.empty() && pending_.load(std::memory_order_seq_cst) == 0;
+            }
+
+            // Approximate when producers/consumers are active (including values spilled)
+            std::size_t size() const
+            {
+                return ring_.size() + pending_.load(std::memory_order_relaxed);
+            }
+
+            std::size_t capacity() const
+            {
+                return ring_.capacity();
+            }
+
+            backpressure_metrics metrics() const
+            {
+                return counters_.metrics();
+            }
+
+        private:
+            void spill(const T* values, std::size_t count)
+            {
+                std::scoped_lock lock{ mutex_ };
+                std::size_t pushed = 0;
+                if (pending_.load(std::memory_order_relaxed) == 0)
+                {
+                    // Consumers may have made room meanwhile
+                    pushed = ring_.push_batch(values, count);
+                }
+                if (pushed < count)
+                {
+                    file_.append(values + pushed, count - pushed);
+                    pending_.fetch_add(count - pushed, std::memory_order_release);
+                    counters_.add(counters_.spilled, count - pushed);
+                }
+            }
+
+            ring_for_t<T, multi_producer, multi_consumer> ring_;
+            std::mutex mutex_;
+            spill_file<T> file_;
+            std::atomic<std::size_t> pending_{ 0 };
+            backpressure_counters counters_;
+        };
+    }
+}
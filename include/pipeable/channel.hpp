@@ -0,0 +1,145 @@
+#pragma once
+
+#include <pipeable/backpressure.hpp>
+#include <pipeable/data_source.hpp>
+#include <pipeable/internal/span.hpp>
+#include <atomic>
+#include <cstddef>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+namespace pipeable
+{
+    enum class channel_mode
+    {
+        spsc,   // Single producer thread, single consumer thread
+        mpmc    // Any number of producer & consumer threads
+    };
+
+    /*
+    Bounded lock-free queue handing values from one thread to another, eg. to split a pipe in thread separated stages:
+    the producing side uses the channel as the sink of a pipe ('value >>= channel'), the consuming side as a data_source.
+    Pushing to a full channel applies the backpressure policy (by default blocks, ie. yields, until there is room).
+    Pulling blocks (yields) until a value is available or the channel is closed.
+    Once closed (by a producer), consumers get the values still queued, then an empty optional.
+    */
+    template<typename T, channel_mode mode = channel_mode::spsc, typename policy_t = backpressure::block>
+    class channel final : public data_source<T>
+    {
+        using queue_t = impl::backpressure_queue<T, policy_t, mode == channel_mode::mpmc, mode == channel_mode::mpmc>;
+
+    public:
+        static constexpr std::size_t default_capacity = 1024;
+
+        explicit channel(std::size_t capacity = default_capacity, policy_t policy = {}) :
+            queue_(capacity, std::move(policy))
+        {}
+
+        template<typename arg_t,
+            std::enable_if_t<std::is_constructible_v<T, arg_t&&>, std::nullptr_t> = nullptr>
+        void operator()(arg_t&& value)
+        {
+            queue_.push(std::forward<arg_t>(value));
+        }
+
+        template<typename arg_t,
+            std::enable_if_t<std::is_constructible_v<T, arg_t&&>, std::nullptr_t> = nullptr>
+        bool try_push(arg_t&& value)
+        {
+            return queue_.try_push(std::forward<arg_t>(value));
+        }
+
+        // Publish all values (as few batches as the consumer(s) allow), applying the backpressure policy to those that don't fit
+        void push_batch(span<const T> values)
+        {
+            queue_.push_batch(values.data(), values.size());
+        }
+
+        // Publish as many values as fit, returns count pushed
+        std::size_t try_push_batch(span<const T> values)
+        {
+            return queue_.try_push_batch(values.data(), values.size());
+        }
+
+        std::optional<T> next() override
+        {
+            std::optional<T> value;
+            pull([&](T&& popped) { value.emplace(std::move(popped)); }, 1);
+            return value;
+        }
+
+        // Move up to 'values.size()' values into 'values' (at least one, unless closed & drained), returns count pulled
+        std::size_t pop_batch(span<T> values)
+        {
+            std::size_t count = 0;
+            pull([&](T&& popped) { values[count++] = std::move(popped); }, values.size());
+            return count;
+        }
+
+        std::size_t next_batch(span<T> values) override
+        {
+            return pop_batch(values);
+        }
+
+        bool supports_batch() const noexcept override
+        {
+            return true;
+        }
+
+        // Signal that no more values will be pushed
+        void close()
+        {
+            closed_.store(true, std::memory_order_release);
+        }
+
+        bool closed() const
+        {
+            return closed_.load(std::memory_order_acquire);
+        }
+
+        // Approximate when producers/consumers are active
+        std::size_t size() const
+        {
+            return queue_.size();
+        }
+
+        std::size_t capacity() const
+        {
+            return queue_.capacity();
+        }
+
+        // Values dropped, coalesced or spilled so far
+        backpressure_metrics metrics() const
+        {
+            return queue_.metrics();
+        }
+
+    private:
+        template<typename consumer_t>
+        void pull(consumer_t&& consumer, std::size_t max)
+        {
+            if (max == 0)
+            {
+                return;
+            }
+            while (queue_.pop_batch(consumer, max) == 0)
+            {
+                if (closed())
+                {
+                    // Values pushed before closing are visible now
+                    queue_.pop_batch(consumer, max);
+                    return;
+                }
+                std::this_thread::yield();
+            }
+        }
+
+        queue_t queue_;
+        alignas(impl::cache_line_size) std::atomic<bool> closed_{ false };
+    };
+
+    template<typename T, typename policy_t = backpressure::block>
+    using mpmc_channel = channel<T, channel_mode::mpmc, policy_t>;
+}
@@ -1,101 +1,288 @@
 #pragma once
 
 #include <pipeable/pipeable.hpp>
-#include <functional>
-#include <vector>
+#include <pipeable/internal/delegate.hpp>
+#include <pipeable/internal/receiver_list.hpp>
+#include <pipeable/internal/span.hpp>
+#include <array>
+#include <tuple>
 
 namespace pipeable
 {
+    namespace impl
+    {
+        // Receivers deriving from this are passed whole batches (see data_generator::emit_batch)
+        struct batch_receiver_tag {};
+    }
+
+    namespace meta
+    {
+        template<typename T>
+        constexpr bool is_batch_receiver_v = std::is_base_of_v<impl::batch_receiver_tag, meta::referenced_t<T>>;
+    }
+
     namespace concepts
     {
         template<typename from_t, typename to_t>
         using IsConvertible = std::enable_if_t<std::is_convertible_v<from_t, to_t>, details::tag_t<0>>;
     }
 
+    // Handle to a single registration (one receiver_id per output type), deregister with 'generator -= subscription'
+    template<typename... outputs_t>
+    struct subscription
+    {
+        std::array<impl::receiver_id, sizeof...(outputs_t)> ids{};
+    };
+
     namespace impl
     {
-        template<typename T>
-        struct non_threadsafe_receivers : std::vector<T>
+        template<typename list_t>
+        struct non_threadsafe_receivers : list_t
         {
             template<typename callback_t>
             void for_each(callback_t&& callback) const
             {
-                for (auto&& downstream : *this)
+                for (auto&& downstream : this->invokers())
                 {
                     std::forward<callback_t>(callback)(std::forward<decltype(downstream)>(downstream));
                 }
             }
 
+            // Invoke 'callback(downstream, value)' for each receiver
+            template<typename value_t, typename callback_t>
+            void fan_out(const value_t& value, callback_t callback) const
+            {
+                for (auto&& downstream : this->invokers())
+                {
+                    callback(downstream, value);
+                }
+            }
+
+            // Applied in place, its modifications are undone if 'callback' throws
             template<typename callback_t>
             void modify_list(callback_t&& callback)
             {
-                std::forward<callback_t>(callback)(*this);
+                this->transact(std::forward<callback_t>(callback));
+            }
+
+            // Applied in place: 'callback' must leave the list unchanged if it throws
+            template<typename callback_t>
+            void update_list(callback_t&& callback)
+            {
+                std::forward<callback_t>(callback)(static_cast<list_t&>(*this));
             }
         };
 
-        template<typename receiver_t, typename>
+        template<typename list_t, typename>
         struct receivers_t
         {
         };
 
         struct non_thread_safe{};
-        template<typename receiver_t>
-        struct receivers_t<receiver_t, non_thread_safe>
+        template<typename list_t>
+        struct receivers_t<list_t, non_thread_safe>
         {
-            using type_t = non_threadsafe_receivers<receiver_t>;
+            using type_t = non_threadsafe_receivers<list_t>;
         };
 
+        struct batch_tag {};
+
         template<typename output_t, typename collection_type_tag_t>
         struct data_generator_impl : impl::custom_pipeable_tag
         {
-            using downstream_t = std::function<void(output_t)>;
+            using value_t = std::remove_cv_t<std::remove_reference_t<output_t>>;
+            // Non-const l-value reference output can be mutated by receivers, everything else is emitted as const
+            static constexpr bool is_mutable_output_v = std::is_lvalue_reference_v<output_t> && !std::is_const_v<std::remove_reference_t<output_t>>;
+            using batch_t = span<std::conditional_t<is_mutable_output_v, value_t, const value_t>>;
+            using downstream_t = impl::basic_delegate<PIPEABLE_DELEGATE_INLINE_CAPACITY, void(output_t), void(batch_tag, batch_t)>;
 
             template<typename arg_t,
                 concepts::IsConvertible<arg_t, output_t> = nullptr>
             void operator()(arg_t&& arg) const
+            {
+                if constexpr (std::is_rvalue_reference_v<output_t>)
+                {
+                    receivers_.for_each([&](auto&& downstream) {
+                        std::forward<decltype(downstream)>(downstream)(std::move(arg));
+                    });
+                }
+                else if constexpr (is_mutable_output_v)
+                {
+                    receivers_.for_each([&](auto&& downstream) {
+                        std::forward<decltype(downstream)>(downstream)(arg);
+                    });
+                }
+                else
+                {
+                    // Intentionally don't forward here, since if we have multiple receivers and the value is "moved from" 
+                    // into the first, remaining receivers will (if it can be moved from) not get the value.
+                    // Receivers only read the value, so they all share it (and may be invoked concurrently).
+                    const value_t& value = arg;
+                    receivers_.fan_out(value, [](const downstream_t& downstream, const value_t& value) {
+                        downstream(value);
+                    });
+                }
+            }
+
+            // Emit all values with a single call per receiver. Batch receivers (invocable with batch_t) receive the whole batch,
+            // remaining receivers are invoked once per value (as if emitted one by one).
+            void emit_batch(batch_t batch) const
             {
                 receivers_.for_each([&](auto&& downstream) {
-                    if constexpr (std::is_rvalue_reference_v<output_t>)
-                    {
-                        std::forward<decltype(downstream)>(downstream).second(std::move(arg));
-                    }
-                    else
-                    {
-                        // Intentionally don't forward here, since if we have multiple receivers and the value is "moved from" 
-                        // into the first, remaining receivers will (if it can be moved from) not get the value.
-                        std::forward<decltype(downstream)>(downstream).second(arg);
-                    }
+                    std::forward<decltype(downstream)>(downstream)(batch_tag{}, batch);
                 });
             }
 
-            template<typename callable_t,
-                concepts::IsInvocable<callable_t, output_t> = nullptr>
-            void operator+=(callable_t&& downstream)
+            using list_t = receiver_list<downstream_t>;
+
+            // Registrations applied to the receiver list as a single modification (one copy & publish when thread safe)
+            struct transaction
             {
-                auto id = identifier(downstream);
-                downstream_t receiverCall = [downstream = downstream](auto&& arg) mutable
+                template<typename callable_t,
+                    concepts::IsInvocable<callable_t, output_t> = nullptr>
+                receiver_id operator+=(callable_t&& downstream)
                 {
-                    invocation::invoke(FWD(downstream), FWD(arg));
-                };
-                receivers_.modify_list([&](auto& receivers) {
-                    receivers.emplace_back(id, receiverCall);
+                    return insert(downstream, FWD(downstream));
+                }
+
+                // Register 'downstream', identified as 'identity' when deregistering by pointer (eg. a wrapper of 'identity')
+                template<typename identity_t, typename callable_t,
+                    concepts::IsInvocable<callable_t, output_t> = nullptr>
+                receiver_id insert(const identity_t& identity, callable_t&& downstream)
+                {
+                    // Moved if an r-value (multi_generator passes an l-value to all but the last matching output)
+                    return receivers.insert(identifier(identity), receiver_call<std::decay_t<callable_t>>{ FWD(downstream) });
+                }
+
+                // Deregister a single receiver in O(1)
+                void operator-=(receiver_id id)
+                {
+                    receivers.erase(id);
+                }
+
+                // Deregister all registrations of a receiver pointer (non-pointer receivers are deregistered by receiver_id)
+                template<typename callable_t,
+                    concepts::IsInvocable<callable_t, output_t> = nullptr,
+                    typename = std::enable_if_t<std::is_pointer_v<std::decay_t<callable_t>>>>
+                void operator-=(callable_t&& downstream)
+                {
+                    receivers.erase(identifier(downstream));
+                }
+
+                list_t& receivers;
+            };
+
+            // Apply all registrations made through 'callback(transaction&)' at once, or none of them if 'callback' throws
+            template<typename callback_t>
+            void modify(callback_t&& callback)
+            {
+                receivers_.modify_list([&](list_t& receivers) {
+                    transaction tx{ receivers };
+                    std::forward<callback_t>(callback)(tx);
                 });
             }
 
             template<typename callable_t,
                 concepts::IsInvocable<callable_t, output_t> = nullptr>
+            receiver_id operator+=(callable_t&& downstream)
+            {
+                receiver_id id;
+                update([&](transaction& tx) {
+                    id = tx += FWD(downstream);
+                });
+                return id;
+            }
+
+            void operator-=(receiver_id id)
+            {
+                update([&](transaction& tx) {
+                    tx -= id;
+                });
+            }
+
+            template<typename callable_t,
+                concepts::IsInvocable<callable_t, output_t> = nullptr,
+                typename = std::enable_if_t<std::is_pointer_v<std::decay_t<callable_t>>>>
             void operator-=(callable_t&& downstream)
             {
-                receivers_.modify_list([&](auto& receivers){
-                    receivers.erase(std::remove_if(receivers.begin(), receivers.end(), [addr = identifier(downstream)](auto&& receiver) {
-                        return receiver.first == addr;
-                    }), receivers.end());
+                update([&](transaction& tx) {
+                    tx -= FWD(downstream);
+                });
+            }
+
+        protected:
+            // Eg. for configuration specific to the type of receiver collection
+            auto& receiver_collection()
+            {
+                return receivers_;
+            }
+
+            const auto& receiver_collection() const
+            {
+                return receivers_;
+            }
+
+            // A single registration or deregistration leaves the list unchanged if it throws, so it needs no journal
+            template<typename callback_t>
+            void update(callback_t&& callback)
+            {
+                receivers_.update_list([&](list_t& receivers) {
+                    transaction tx{ receivers };
+                    std::forward<callback_t>(callback)(tx);
                 });
             }
 
         private:
 
-            typename receivers_t<std::pair<const void*, downstream_t>, collection_type_tag_t>::type_t receivers_;
+            template<typename callable_t>
+            struct receiver_call
+            {
+                template<typename arg_t>
+                void operator()(arg_t&& arg)
+                {
+                    invocation::invoke(callable, FWD(arg));
+                }
+
+                // Batch support is opt-in: probing arbitrary callables (eg. generic lambdas) with batch_t may hard-error
+                static constexpr bool accepts_batch()
+                {
+                    if constexpr (meta::is_batch_receiver_v<callable_t>)
+                    {
+                        return meta::is_invocable_v<callable_t, batch_t>;
+                    }
+                    else
+                    {
+                        return false;
+                    }
+                }
+
+                void operator()(batch_tag, batch_t batch)
+                {
+                    if constexpr (accepts_batch())
+                    {
+                        invocation::invoke(callable, batch);
+                    }
+                    else
+                    {
+                        for (auto& value : batch)
+                        {
+                            if constexpr (std::is_lvalue_reference_v<output_t>)
+                            {
+                                invocation::invoke(callable, value);
+                            }
+                            else
+                            {
+                                // By value (or r-value) output: each receiver gets its own copy
+                                invocation::invoke(callable, value_t(value));
+                            }
+                        }
+                    }
+                }
+
+                callable_t callable;
+            };
+
+            typename receivers_t<list_t, collection_type_tag_t>::type_t receivers_;
 
             template<typename callable_t>
             static constexpr const void* identifier(const callable_t& callable)
@@ -115,6 +302,7 @@ namespace pipeable
         struct multi_generator_impl : bases_t...
         {
             using bases_t::operator()...;
+            using bases_t::emit_batch...;
             using bases_t::operator+=...;
             using bases_t::operator-=...;
         };
@@ -122,52 +310,173 @@ namespace pipeable
         template<typename threading_t, typename... outputs_t>
         struct multi_generator : impl::multi_generator_impl<impl::data_generator_impl<outputs_t, threading_t>...>
         {
+        protected:
+            template<std::size_t index>
+            using output_t = std::tuple_element_t<index, std::tuple<outputs_t...>>;
+
+            template<std::size_t index>
+            using base_t = impl::data_generator_impl<output_t<index>, threading_t>;
+
+        public:
+
+            // Registrations for all output types, applied as a single modification per output type
+            struct transaction
+            {
+                template<typename callable_t,
+                    concepts::IsInvocableWithAny<callable_t, outputs_t...> = nullptr>
+                subscription<outputs_t...> operator+=(callable_t&& downstream)
+                {
+                    subscription<outputs_t...> sub;
+                    for_each_matching_output<callable_t>([&](auto index) {
+                        sub.ids[index] = *std::get<index>(bases) += forward_to<index, callable_t>(downstream);
+                    });
+                    return sub;
+                }
+
+                template<typename callable_t,
+                    concepts::IsInvocableWithAny<callable_t, outputs_t...> = nullptr,
+                    typename = std::enable_if_t<std::is_pointer_v<std::decay_t<callable_t>>>>
+                void operator-=(callable_t&& downstream)
+                {
+                    for_each_matching_output<callable_t>([&](auto index) {
+                        *std::get<index>(bases) -= downstream;
+                    });
+                }
+
+                void operator-=(const subscription<outputs_t...>& sub)
+                {
+                    for_each_subscribed_output(sub, [&](auto index) {
+                        *std::get<index>(bases) -= sub.ids[index];
+                    });
+                }
+
+                std::tuple<typename impl::data_generator_impl<outputs_t, threading_t>::transaction*...> bases;
+            };
+
+            // Apply all registrations made through 'callback(transaction&)' at once
+            template<typename callback_t>
+            void modify(callback_t&& callback)
+            {
+                transaction tx;
+                modify_from<0>(tx, callback);
+            }
+
             template<typename callable_t,
                 concepts::IsInvocableWithAny<callable_t, outputs_t...> = nullptr>
-                void operator+=(callable_t&& downstream)
+                subscription<outputs_t...> operator+=(callable_t&& downstream)
             {
-                // Recursively call += for each output type to find exact base/data_generator
-                auto callback = [](auto&& base, auto&& downstream) {
-                    base->operator+=(FWD(downstream));
-                };
-                do_for_each_matching_generator<callable_t, outputs_t...>(FWD(downstream), callback);
+                // Explicitly call each matching base/data_generator to avoid ambiguity
+                subscription<outputs_t...> sub;
+                for_each_matching_output<callable_t>([&](auto index) {
+                    sub.ids[index] = static_cast<base_t<index>&>(*this) += forward_to<index, callable_t>(downstream);
+                });
+                return sub;
             }
 
+            // Deregister all registrations of a receiver pointer (non-pointer receivers are deregistered by subscription)
             template<typename callable_t,
-                concepts::IsInvocableWithAny<callable_t, outputs_t...> = nullptr>
+                concepts::IsInvocableWithAny<callable_t, outputs_t...> = nullptr,
+                typename = std::enable_if_t<std::is_pointer_v<std::decay_t<callable_t>>>>
                 void operator-=(callable_t&& downstream)
             {
-                // Recursively call -= for each output type to find exact base/data_generator
-                auto callback = [](auto&& base, auto&& downstream)
+                for_each_matching_output<callable_t>([&](auto index) {
+                    static_cast<base_t<index>&>(*this) -= downstream;
+                });
+            }
+
+            void operator-=(const subscription<outputs_t...>& sub)
+            {
+                for_each_subscribed_output(sub, [&](auto index) {
+                    static_cast<base_t<index>&>(*this) -= sub.ids[index];
+                });
+            }
+
+        protected:
+            // Invoke 'callback(index)' for each output type (index) the callable is invocable with
+            template<typename callable_t, typename callback_t>
+            static void for_each_matching_output(callback_t&& callback)
+            {
+                for_each_output([&](auto index) {
+                    if constexpr (meta::is_invocable_v<callable_t, output_t<index>>)
+                    {
+                        callback(index);
+                    }
+                });
+            }
+
+            // The callable is registered once per matching output: copied to all but the last one, where an r-value is moved
+            template<std::size_t index, typename callable_t>
+            static constexpr decltype(auto) forward_to(std::remove_reference_t<callable_t>& downstream)
+            {
+                if constexpr (index == last_matching_output<callable_t>())
+                {
+                    return std::forward<callable_t>(downstream);
+                }
+                else
                 {
-                    base->operator-=(FWD(downstream));
-                };
-                do_for_each_matching_generator<callable_t, outputs_t...>(FWD(downstream), callback);
+                    return (downstream);
+                }
             }
 
-        private:
-            template<typename callable_t, typename output_t, typename callback_t>
-            void do_for_each_matching_generator(callable_t&& downstream, callback_t&& callback)
+            template<typename callable_t>
+            static constexpr std::size_t last_matching_output()
             {
-                // Register callable for matching output only
-                if constexpr (meta::is_invocable_v<callable_t, output_t>)
+                constexpr bool matches[] = { meta::is_invocable_v<callable_t, outputs_t>... };
+                std::size_t last = 0;
+                for (std::size_t index = 0; index < sizeof...(outputs_t); ++index)
                 {
-                    // Explicitly call correct base to avoid ambiguity
-                    using exact_base_t = impl::data_generator_impl<output_t, threading_t>;
-                    callback(static_cast<exact_base_t*>(this), FWD(downstream));
+                    last = matches[index] ? index : last;
                 }
+                return last;
             }
 
-            template<typename callable_t, typename output_t, typename tail_t, typename... tails_t, typename callback_t>
-            void do_for_each_matching_generator(callable_t&& downstream, callback_t&& callback)
+            // Invoke 'callback(index)' for each output type (index) the subscription holds a valid id for
+            template<typename callback_t>
+            static void for_each_subscribed_output(const subscription<outputs_t...>& sub, callback_t&& callback)
             {
-                do_for_each_matching_generator<callable_t, output_t>(FWD(downstream), FWD(callback));
-                // Recursively register callable for each (matching) output type
-                do_for_each_matching_generator<callable_t, tail_t, tails_t...>(FWD(downstream), FWD(callback));
+                for_each_output([&](auto index) {
+                    if (sub.ids[index])
+                    {
+                        callback(index);
+                    }
+                });
+            }
+
+            template<typename callback_t>
+            static void for_each_output(callback_t&& callback)
+            {
+                for_each_output(callback, std::index_sequence_for<outputs_t...>());
+            }
+
+            template<typename callback_t, std::size_t... indexes>
+            static void for_each_output(callback_t& callback, std::index_sequence<indexes...>)
+            {
+                (callback(std::integral_constant<std::size_t, indexes>()), ...);
+            }
+
+        private:
+            // Open the transaction of each base in turn (nested), and invoke callback with all of them open
+            template<std::size_t index, typename callback_t>
+            void modify_from(transaction& tx, callback_t& callback)
+            {
+                if constexpr (index == sizeof...(outputs_t))
+                {
+                    callback(tx);
+                }
+                else
+                {
+                    static_cast<base_t<index>&>(*this).modify([&](auto& baseTx) {
+                        std::get<index>(tx.bases) = &baseTx;
+                        modify_from<index + 1>(tx, callback);
+                    });
+                }
             }
         };
     }
 
+    // Derive receiver from this to receive whole batches, eg. 'void operator()(span<const int> values)'
+    using batch_receiver = impl::batch_receiver_tag;
+
     template<typename... outputs_t>
     struct data_generator : impl::multi_generator<impl::non_thread_safe, outputs_t...>
     {};
@@ -1,76 +1,243 @@
 #pragma once
 
+#include <pipeable/internal/span.hpp>
+#include <array>
+#include <cstddef>
 #include <iterator>
+#include <memory>
+#include <new>
 #include <optional>
 #include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace pipeable
 {
-    /*
-    Provides basic functionality for creating a "data source", which
-    can be iterated to extract data until no value is returned (empty optional).
-    Prefer marking derived classes as "final" to allow devirtualization.
-    */
-    template<typename T>
-    struct data_source
+    namespace impl
     {
-        virtual std::optional<T> next() = 0;
+        // End of a source iteration: reached once 'next()' returned an empty optional
+        struct source_sentinel {};
 
-        struct iterator
+        // Iterates a source (data_source or static_data_source) through 'next()' until an empty optional.
+        // Elements are handed out as r-values (pulled values aren't shared), so move-only values can be moved downstream.
+        template<typename source_t, typename T>
+        struct source_iterator
         {
             using iterator_category = std::input_iterator_tag;
             using value_type = std::decay_t<T>;
-            using reference = value_type const&;
-            using pointer = value_type const*;
+            using reference = value_type&&;
+            using pointer = value_type*;
             using difference_type = ptrdiff_t;
 
-            iterator(data_source& source, bool end) :
+            explicit source_iterator(source_t& source) :
                 source_(source)
             {
-                if (!end)
-                {
-                    ++(*this);
-                }
+                ++(*this);
             }
-            bool operator== (iterator const& other) const
+            bool operator== (source_sentinel) const
             {
-                return this->current_ == other.current_;
+                return !current_.has_value();
             }
-            bool operator!= (iterator const& other) const
+            bool operator!= (source_sentinel) const
             {
-                return !(*this == other);
+                return current_.has_value();
+            }
+            friend bool operator== (source_sentinel end, source_iterator const& it)
+            {
+                return it == end;
+            }
+            friend bool operator!= (source_sentinel end, source_iterator const& it)
+            {
+                return it != end;
             }
             explicit operator bool() const
             {
                 return !current_.has_value();
             }
-            reference operator*() const
+            reference operator*()
             {
-                return current_.value();
+                return std::move(*current_);
             }
-            pointer operator->() const
+            pointer operator->()
             {
-                return &current_.value();
+                return &*current_;
             }
 
-            iterator& operator++()
+            source_iterator& operator++()
             {
                 current_ = source_.next();
                 return *this;
             }
 
         private:
-            data_source& source_;
+            source_t& source_;
             std::optional<T> current_;
         };
 
+        // Blocks can be pulled if values can be stored in a buffer up front
+        template<typename T>
+        inline constexpr bool is_batchable_v = std::is_default_constructible_v<T> && !std::is_same_v<T, bool>;
+
+        // Pull up to 'values.size()' values one by one through 'source.next()', returns count pulled
+        template<typename source_t, typename T>
+        std::size_t pull_one_by_one(source_t& source, span<T> values)
+        {
+            std::size_t count = 0;
+            for (; count < values.size(); ++count)
+            {
+                auto value = source.next();
+                if (!value)
+                {
+                    break;
+                }
+                if constexpr (std::is_move_assignable_v<T>)
+                {
+                    values[count] = std::move(*value);
+                }
+                else
+                {
+                    values[count].~T();
+                    ::new (static_cast<void*>(&values[count])) T(std::move(*value));
+                }
+            }
+            return count;
+        }
+
+        // Blocks up to this size are pulled into a buffer on the stack
+        inline constexpr std::size_t max_stack_block_bytes = 16 * 1024;
+
+        template<typename T, typename source_t, typename callback_t>
+        void pull_blocks(source_t& source, span<T> block, callback_t& callback)
+        {
+            while (const auto count = source.next_batch(block))
+            {
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    callback(std::move(block[i]));
+                }
+            }
+        }
+
+        // Pass each value of 'source' to 'callback': pulling a block per 'source.next_batch()' call if 'batched', else a value per 'source.next()' call
+        template<bool batched, typename T, std::size_t batch_size, typename source_t, typename callback_t>
+        void pull_each(source_t& source, callback_t&& callback)
+        {
+            if constexpr (batched && sizeof(T) * batch_size <= max_stack_block_bytes)
+            {
+                std::array<T, batch_size> block;
+                pull_blocks(source, span<T>(block.data(), block.size()), callback);
+            }
+            else if constexpr (batched)
+            {
+                std::vector<T> block(batch_size);
+                pull_blocks(source, span<T>(block.data(), block.size()), callback);
+            }
+            else
+            {
+                while (auto value = source.next())
+                {
+                    callback(std::move(*value));
+                }
+            }
+        }
+    }
+
+    /*
+    Provides basic functionality for creating a "data source", which
+    can be iterated to extract data until no value is returned (empty optional).
+    Iterating hands out values as r-values (end is a sentinel), so move-only values can be pulled too.
+    Prefer marking derived classes as "final" to allow devirtualization (or see static_data_source).
+    Override 'next_batch()' to pull many values per (virtual) call: 'for_each' then pulls blocks of 'batch_size' values.
+    Override 'supports_batch()' as well, so blocks are also pulled through a data_source reference (dynamic type unknown).
+    Override 'try_split()' to allow consuming disjoint parts of the values in parallel (see parallel_for_each).
+    */
+    template<typename T>
+    struct data_source
+    {
+        static constexpr std::size_t batch_size = 256;
+
+        // Parts split off are owned (and deleted) through this base
+        virtual ~data_source() = default;
+
+        virtual std::optional<T> next() = 0;
+
+        // Pull up to 'values.size()' values into 'values', returns count pulled (0 once there are no more values).
+        // Default pulls values one by one through 'next()'.
+        virtual std::size_t next_batch(span<T> values)
+        {
+            return impl::pull_one_by_one(*this, values);
+        }
+
+        // Whether 'next_batch()' is overridden to pull many values per call (else 'for_each' pulls each value through 'next()')
+        virtual bool supports_batch() const noexcept
+        {
+            return false;
+        }
+
+        // Split off part of the values not pulled yet into an independent source (this one keeps the rest),
+        // or nullptr if this source can't be split (default). Both sources can then be pulled concurrently.
+        virtual std::unique_ptr<data_source> try_split()
+        {
+            return nullptr;
+        }
+
+        // Split into up to 'partitions' disjoint sources (including this one), by splitting each part in turn until enough or none splits.
+        // Returns the parts split off.
+        std::vector<std::unique_ptr<data_source>> split(std::size_t partitions)
+        {
+            std::vector<std::unique_ptr<data_source>> parts;
+            for (auto splitting = true; splitting && parts.size() + 1 < partitions;)
+            {
+                splitting = false;
+                // Split this one and each part split so far once per round, so halving splits stay balanced
+                for (std::size_t i = 0, count = parts.size() + 1; i < count && parts.size() + 1 < partitions; ++i)
+                {
+                    auto& part = i == 0 ? *this : *parts[i - 1];
+                    if (auto splitOff = part.try_split())
+                    {
+                        parts.push_back(std::move(splitOff));
+                        splitting = true;
+                    }
+                }
+            }
+            return parts;
+        }
+
+        // Whether 'for_each' pulls blocks from 'source_t', known at compile time: if its static type overrides next_batch
+        // (else values would just be read ahead of delivery, through a virtual next() per value anyway)
+        template<typename source_t>
+        static constexpr bool pulls_in_batches = impl::is_batchable_v<T>
+            && !std::is_same_v<decltype(&source_t::next_batch), std::size_t (data_source::*)(span<T>)>;
+
+        // Pass each value of 'source' (of static type 'source_t') to 'callback', as 'for_each' does.
+        // Unless known at compile time, asks the source once whether to pull blocks (devirtualized for final sources).
+        template<typename source_t, typename callback_t>
+        static void pull_each(source_t& source, callback_t&& callback)
+        {
+            if constexpr (pulls_in_batches<source_t> || !impl::is_batchable_v<T>)
+            {
+                impl::pull_each<pulls_in_batches<source_t>, T, batch_size>(source, callback);
+            }
+            else if (source.supports_batch())
+            {
+                impl::pull_each<true, T, batch_size>(source, callback);
+            }
+            else
+            {
+                impl::pull_each<false, T, batch_size>(source, callback);
+            }
+        }
+
+        using iterator = impl::source_iterator<data_source, T>;
+        using sentinel = impl::source_sentinel;
+
         iterator begin()
         {
-            return iterator(*this, false);
+            return iterator(*this);
         }
-        iterator end()
+        sentinel end()
         {
-            return iterator(*this, true);
+            return {};
         }
     };
 }
\ No newline at end of file
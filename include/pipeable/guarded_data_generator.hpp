@@ -1,52 +1,383 @@
 #pragma once
 
 #include <pipeable/data_generator.hpp>
+#include <pipeable/thread_pool.hpp>
+#include <pipeable/internal/epoch.hpp>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
 #include <memory>
 #include <mutex>
+#include <optional>
+#include <thread>
 #include <vector>
 
 namespace pipeable
 {
+    // How a single emission is spread over receivers (by default: sequentially, on the emitting thread).
+    // A receiver throwing on the pool doesn't stop other receivers from being invoked. When waiting, the first exception
+    // is rethrown to the emitter once all receivers completed. Otherwise it's dropped, and counted (see 'fan_out_failures()').
+    struct fan_out_policy
+    {
+        thread_pool* pool = nullptr;        // If null, receivers are always invoked sequentially
+        std::size_t min_receivers = 64;     // Fewer receivers are invoked sequentially
+        std::size_t chunk_size = 16;        // Receivers invoked (sequentially) by one task
+        bool wait = true;                   // Wait for all receivers to complete, else return once chunks are scheduled (value is copied, if copyable)
+    };
+
     namespace impl
     {
-        template<typename T>
+        /*
+        Receivers of one emission, split into chunks grabbed by the emitting thread and pool tasks.
+        Shared with tasks, since tasks may start after all chunks have been grabbed (and the emission has returned).
+        Exceptions of receivers are caught, so every chunk completes: the first is kept in 'error', all are counted in 'failures'.
+        */
+        template<typename snapshot_t, typename value_t, typename callback_t>
+        struct fan_out_job
+        {
+            template<typename... args_t>
+            fan_out_job(const snapshot_t& snapshot, std::atomic<std::uint64_t>& failures, std::size_t chunkSize, callback_t callback, args_t&&... ownedValue) :
+                snapshot(snapshot),
+                failures(failures),
+                chunkSize(chunkSize),
+                chunks((snapshot.list.invokers().size() + chunkSize - 1) / chunkSize),
+                callback(callback),
+                ownedValue(std::forward<args_t>(ownedValue)...)
+            {
+                if (this->ownedValue)
+                {
+                    value = &*this->ownedValue;
+                    // Keep snapshot alive until job is done
+                    snapshot.users.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+
+            ~fan_out_job()
+            {
+                if (ownedValue)
+                {
+                    snapshot.users.fetch_sub(1, std::memory_order_release);
+                }
+            }
+
+            // Invoke chunks until none is left. Returns once no more chunks can be grabbed.
+            void run()
+            {
+                for (auto chunk = next.fetch_add(1, std::memory_order_relaxed); chunk < chunks; chunk = next.fetch_add(1, std::memory_order_relaxed))
+                {
+                    const auto& invokers = snapshot.list.invokers();
+                    const auto end = std::min(invokers.size(), (chunk + 1) * chunkSize);
+                    for (auto i = chunk * chunkSize; i < end; ++i)
+                    {
+                        try
+                        {
+                            callback(invokers[i], *value);
+                        }
+                        catch (...)
+                        {
+                            failures.fetch_add(1, std::memory_order_relaxed);
+                            std::scoped_lock lock{ mutex };
+                            if (!error)
+                            {
+                                error = std::current_exception();
+                            }
+                        }
+                    }
+                    if (completed.fetch_add(1, std::memory_order_acq_rel) + 1 == chunks)
+                    {
+                        std::scoped_lock lock{ mutex };
+                        done.notify_all();
+                    }
+                }
+            }
+
+            void wait()
+            {
+                std::unique_lock lock{ mutex };
+                done.wait(lock, [this] { return completed.load(std::memory_order_acquire) == chunks; });
+            }
+
+            const snapshot_t& snapshot;
+            std::atomic<std::uint64_t>& failures;
+            const std::size_t chunkSize;
+            const std::size_t chunks;
+            callback_t callback;
+            std::optional<value_t> ownedValue;
+            const value_t* value = nullptr;
+            std::atomic<std::size_t> next{ 0 };
+            std::atomic<std::size_t> completed{ 0 };
+            std::mutex mutex;
+            std::condition_variable done;
+            std::exception_ptr error; // Guarded by mutex
+        };
+
+        /*
+        Readers (emitting threads) iterate a published snapshot of the list, protected by an epoch pin instead of a
+        reference count. Writers copy, modify & publish a new snapshot, then destroy retired snapshots no reader can still observe.
+        */
+        template<typename list_t>
         struct threadsafe_receivers
         {
+            threadsafe_receivers() = default;
+            threadsafe_receivers(const threadsafe_receivers&) = delete;
+            threadsafe_receivers& operator=(const threadsafe_receivers&) = delete;
+
+            ~threadsafe_receivers()
+            {
+                // Wait for detached (fire-and-forget) fan-outs still invoking receivers
+                for (auto& retired : retired_)
+                {
+                    wait_unused(*retired.snapshot);
+                }
+                std::unique_ptr<container_t> current{ receivers_.load(std::memory_order_relaxed) };
+                wait_unused(*current);
+            }
+
             template<typename callback_t>
             void for_each(callback_t&& callback) const
             {
-                auto tmp = std::atomic_load(&receivers_);
-                for (auto&& downstream : *tmp)
+                auto pin = epoch_domain::instance().pin();
+                auto tmp = receivers_.load(std::memory_order_seq_cst);
+                for (auto&& downstream : tmp->list.invokers())
                 {
                     std::forward<callback_t>(callback)(std::forward<decltype(downstream)>(downstream));
                 }
             }
 
+            // Invoke 'callback(downstream, value)' for each receiver, according to the fan-out policy
+            template<typename value_t, typename callback_t>
+            void fan_out(const value_t& value, callback_t callback) const
+            {
+                auto pin = epoch_domain::instance().pin();
+                const auto& snapshot = *receivers_.load(std::memory_order_seq_cst);
+                const auto& invokers = snapshot.list.invokers();
+                if (!fanOut_.pool || invokers.size() < fanOut_.min_receivers)
+                {
+                    for (auto&& downstream : invokers)
+                    {
+                        callback(downstream, value);
+                    }
+                    return;
+                }
+
+                using job_t = fan_out_job<container_t, value_t, callback_t>;
+                const auto chunkSize = std::max<std::size_t>(1, fanOut_.chunk_size);
+                // A value that can't be copied is only valid while emitting, so emission always waits for it
+                if (fanOut_.wait || !std::is_copy_constructible_v<value_t>)
+                {
+                    auto job = std::make_shared<job_t>(snapshot, failures_, chunkSize, callback);
+                    job->value = &value;
+                    {
+                        // Tasks reference the value & snapshot of this emission: wait for them, even if submitting throws.
+                        // Emitting thread grabs chunks as well, so the emission completes even if all workers are busy.
+                        struct finish_t
+                        {
+                            ~finish_t()
+                            {
+                                job.run();
+                                job.wait();
+                            }
+
+                            job_t& job;
+                        } finish{ *job };
+                        for (std::size_t i = 1; i < std::min(job->chunks, fanOut_.pool->size() + 1); ++i)
+                        {
+                            fanOut_.pool->submit([job] { job->run(); });
+                        }
+                    }
+                    if (job->error)
+                    {
+                        std::rethrow_exception(job->error);
+                    }
+                }
+                else if constexpr (std::is_copy_constructible_v<value_t>)
+                {
+                    auto job = std::make_shared<job_t>(snapshot, failures_, chunkSize, callback, value);
+                    for (std::size_t i = 0; i < std::min(job->chunks, fanOut_.pool->size()); ++i)
+                    {
+                        fanOut_.pool->submit([job] { job->run(); });
+                    }
+                }
+            }
+
+            // Not thread safe: configure before emitting
+            void set_fan_out(const fan_out_policy& policy)
+            {
+                fanOut_ = policy;
+            }
+
+            std::uint64_t fan_out_failures() const
+            {
+                return failures_.load(std::memory_order_relaxed);
+            }
+
+            // Modifications are flat combined: each is queued, and whichever thread acquires the lock applies all queued
+            // modifications to one copy, which is published once. Thus concurrent modifiers coalesce into one copy & publication.
+            // A modification throwing is undone (others are still applied), and its exception rethrown to its modifier.
+            // Note 'callback' may thus run on another (the combining) thread, while its modifier waits.
             template<typename callback_t>
             void modify_list(callback_t&& callback)
             {
-                std::scoped_lock lock{ mutex_ };
-                container_t copy = *receivers_;
-                std::forward<callback_t>(callback)(copy);
-                std::atomic_store(&receivers_, std::make_shared<container_t>(std::move(copy)));
+                queue_and_combine(callback, false);
+            }
+
+            // As modify_list, but 'callback' leaves the list unchanged if it throws (so its modifications aren't journaled)
+            template<typename callback_t>
+            void update_list(callback_t&& callback)
+            {
+                queue_and_combine(callback, true);
             }
 
         private:
-            using container_t = std::vector<T>;
+            template<typename callback_t>
+            void queue_and_combine(callback_t& callback, bool inPlace)
+            {
+                pending_t op;
+                op.inPlace = inPlace;
+                op.context = &callback;
+                op.apply = [](void* context, list_t& list) {
+                    (*static_cast<callback_t*>(context))(list);
+                };
+                op.next = pending_.load(std::memory_order_relaxed);
+                while (!pending_.compare_exchange_weak(op.next, &op, std::memory_order_release, std::memory_order_relaxed));
+
+                std::scoped_lock lock{ mutex_ };
+                // If not yet applied by another thread, it's still queued
+                if (!op.done)
+                {
+                    combine();
+                }
+                if (op.error)
+                {
+                    std::rethrow_exception(op.error);
+                }
+            }
+
+            // Published (immutable) list, and count of detached fan-outs still using it
+            struct snapshot_t
+            {
+                explicit snapshot_t(const list_t& list = {}) :
+                    list(list)
+                {}
+
+                list_t list;
+                mutable std::atomic<std::size_t> users{ 0 };
+            };
+            using container_t = snapshot_t;
+
+            struct retired_t
+            {
+                std::unique_ptr<container_t> snapshot;
+                std::uint64_t epoch;
+            };
+
+            // Queued modification, owned by (the stack of) the waiting modifier
+            struct pending_t
+            {
+                void(*apply)(void*, list_t&) = nullptr;
+                void* context = nullptr;
+                pending_t* next = nullptr;
+                bool inPlace = false;
+                std::exception_ptr error;
+                bool done = false; // Guarded by mutex_
+            };
+
+            // Apply all queued modifications (in order) to a copy of the list, and publish it. Requires mutex_.
+            // Unless applied in place, each modification is a transaction of its own, undone if it throws.
+            void combine()
+            {
+                pending_t* ops = nullptr;
+                for (auto op = pending_.exchange(nullptr, std::memory_order_acquire); op;)
+                {
+                    auto next = op->next;
+                    op->next = ops;
+                    ops = op;
+                    op = next;
+                }
+
+                auto copy = std::make_unique<container_t>(receivers_.load(std::memory_order_relaxed)->list);
+                bool modified = false;
+                for (auto op = ops; op; op = op->next)
+                {
+                    try
+                    {
+                        if (op->inPlace)
+                        {
+                            op->apply(op->context, copy->list);
+                        }
+                        else
+                        {
+                            copy->list.transact([op](list_t& list) {
+                                op->apply(op->context, list);
+                            });
+                        }
+                        modified = true;
+                    }
+                    catch (...)
+                    {
+                        op->error = std::current_exception();
+                    }
+                    op->done = true;
+                }
+                if (!modified)
+                {
+                    return;
+                }
+                std::unique_ptr<container_t> old{ receivers_.exchange(copy.release(), std::memory_order_seq_cst) };
+                retired_.push_back({ std::move(old), epoch_domain::instance().advance() });
+                reclaim();
+            }
+
+            // Retired snapshots are destroyed on modification (or with the generator)
+            void reclaim()
+            {
+                const auto minEpoch = epoch_domain::instance().min_active_epoch();
+                retired_.erase(std::remove_if(retired_.begin(), retired_.end(), [minEpoch](const retired_t& retired) {
+                    return retired.epoch < minEpoch && retired.snapshot->users.load(std::memory_order_acquire) == 0;
+                }), retired_.end());
+            }
+
+            static void wait_unused(const container_t& snapshot)
+            {
+                while (snapshot.users.load(std::memory_order_acquire) != 0)
+                {
+                    std::this_thread::yield();
+                }
+            }
 
             std::mutex mutex_;
-            std::shared_ptr<container_t> receivers_ = std::make_shared<container_t>();
+            std::atomic<pending_t*> pending_{ nullptr };
+            std::atomic<container_t*> receivers_{ new container_t() };
+            std::vector<retired_t> retired_;
+            fan_out_policy fanOut_;
+            // Receivers which threw on the pool
+            mutable std::atomic<std::uint64_t> failures_{ 0 };
         };
 
         struct thread_safe {};
-        template<typename receiver_t>
-        struct receivers_t<receiver_t, thread_safe>
+        template<typename list_t>
+        struct receivers_t<list_t, thread_safe>
         {
-            using type_t = threadsafe_receivers<receiver_t>;
+            using type_t = threadsafe_receivers<list_t>;
         };
     }
 
     template<typename... outputs_t>
     struct guarded_data_generator : impl::multi_generator<impl::thread_safe, outputs_t...>
-    {};
+    {
+        // Spread emissions over a thread pool (for outputs receivers can't modify, ie. by value or const reference).
+        // Not thread safe: configure before emitting.
+        void set_fan_out(const fan_out_policy& policy)
+        {
+            (this->impl::data_generator_impl<outputs_t, impl::thread_safe>::receiver_collection().set_fan_out(policy), ...);
+        }
+
+        // Count of exceptions thrown by receivers on the pool (including those rethrown to a waiting emitter)
+        std::uint64_t fan_out_failures() const
+        {
+            return (std::uint64_t(0) + ... + this->impl::data_generator_impl<outputs_t, impl::thread_safe>::receiver_collection().fan_out_failures());
+        }
+    };
 }
\ No newline at end of file
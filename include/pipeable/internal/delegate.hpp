@@ -0,0 +1,224 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Max size (bytes) of callables stored inline (without allocation) by impl::delegate
+#ifndef PIPEABLE_DELEGATE_INLINE_CAPACITY
+#define PIPEABLE_DELEGATE_INLINE_CAPACITY (4 * sizeof(void*))
+#endif
+
+namespace pipeable::impl
+{
+    namespace details
+    {
+        // Holds the invoker (function pointer) of one signature, and exposes the matching call operator
+        template<typename delegate_t, typename signature_t>
+        struct delegate_invoker;
+
+        template<typename delegate_t, typename return_t, typename... args_t>
+        struct delegate_invoker<delegate_t, return_t(args_t...)>
+        {
+            using invoke_t = return_t(*)(void*, args_t...);
+
+            return_t operator()(args_t... args) const
+            {
+                return invoke_(static_cast<const delegate_t&>(*this).context(), std::forward<args_t>(args)...);
+            }
+
+        private:
+            friend delegate_t;
+
+            template<typename callable_t, bool is_inline>
+            static return_t invoke(void* storage, args_t... args)
+            {
+                if constexpr (is_inline)
+                {
+                    return (*static_cast<callable_t*>(storage))(std::forward<args_t>(args)...);
+                }
+                else
+                {
+                    return (**static_cast<callable_t**>(storage))(std::forward<args_t>(args)...);
+                }
+            }
+
+            invoke_t invoke_ = nullptr;
+        };
+    }
+
+    /*
+    Copyable type-erased callable (like std::function) with small-buffer storage, callable with any of 'signatures_t'.
+    Callables fitting 'inline_capacity' (and nothrow movable) are stored inline without allocation,
+    and invocation is a single indirect call to a function pointer + context.
+    Trivially copyable callables (eg. pointers, lambdas capturing pointers) are copied with memcpy.
+    Invoking an empty delegate is undefined.
+    */
+    template<std::size_t inline_capacity, typename... signatures_t>
+    class basic_delegate : public details::delegate_invoker<basic_delegate<inline_capacity, signatures_t...>, signatures_t>...
+    {
+        template<typename, typename>
+        friend struct details::delegate_invoker;
+
+        template<typename signature_t>
+        using invoker_t = details::delegate_invoker<basic_delegate, signature_t>;
+
+        enum class operation { copy, move, destroy };
+
+        using manage_t = void(*)(operation, basic_delegate& dst, basic_delegate* src);
+
+        template<typename callable_t>
+        static constexpr bool is_inline_v =
+            sizeof(callable_t) <= inline_capacity &&
+            alignof(callable_t) <= alignof(std::max_align_t) &&
+            std::is_nothrow_move_constructible_v<callable_t>;
+
+        template<typename callable_t>
+        static constexpr bool is_trivial_v = is_inline_v<callable_t> && std::is_trivially_copyable_v<callable_t>;
+
+        template<typename callable_t, typename signature_t>
+        struct is_callable_with;
+        template<typename callable_t, typename return_t, typename... args_t>
+        struct is_callable_with<callable_t, return_t(args_t...)> : std::is_invocable_r<return_t, callable_t&, args_t...> {};
+
+    public:
+        static constexpr std::size_t capacity = inline_capacity;
+
+        using invoker_t<signatures_t>::operator()...;
+
+        basic_delegate() = default;
+
+        template<typename callable_t, typename decayed_t = std::decay_t<callable_t>,
+            typename = std::enable_if_t<!std::is_same_v<decayed_t, basic_delegate> && (is_callable_with<decayed_t, signatures_t>::value && ...)>>
+        basic_delegate(callable_t&& callable)
+        {
+            if constexpr (is_inline_v<decayed_t>)
+            {
+                ::new (static_cast<void*>(&storage_)) decayed_t(std::forward<callable_t>(callable));
+            }
+            else
+            {
+                ::new (static_cast<void*>(&storage_)) decayed_t*(new decayed_t(std::forward<callable_t>(callable)));
+            }
+            ((invoker_t<signatures_t>::invoke_ = &invoker_t<signatures_t>::template invoke<decayed_t, is_inline_v<decayed_t>>), ...);
+            if constexpr (!is_trivial_v<decayed_t>)
+            {
+                manage_ = &manage<decayed_t>;
+            }
+        }
+
+        basic_delegate(const basic_delegate& other) :
+            invoker_t<signatures_t>(other)...,
+            manage_(other.manage_)
+        {
+            if (manage_)
+            {
+                manage_(operation::copy, *this, const_cast<basic_delegate*>(&other));
+            }
+            else
+            {
+                std::memcpy(&storage_, &other.storage_, sizeof(storage_));
+            }
+        }
+
+        basic_delegate(basic_delegate&& other) noexcept :
+            invoker_t<signatures_t>(other)...,
+            manage_(other.manage_)
+        {
+            if (manage_)
+            {
+                manage_(operation::move, *this, &other);
+            }
+            else
+            {
+                std::memcpy(&storage_, &other.storage_, sizeof(storage_));
+            }
+        }
+
+        basic_delegate& operator=(const basic_delegate& other)
+        {
+            if (this != &other)
+            {
+                basic_delegate tmp(other);
+                *this = std::move(tmp);
+            }
+            return *this;
+        }
+
+        basic_delegate& operator=(basic_delegate&& other) noexcept
+        {
+            if (this != &other)
+            {
+                this->~basic_delegate();
+                ::new (static_cast<void*>(this)) basic_delegate(std::move(other));
+            }
+            return *this;
+        }
+
+        ~basic_delegate()
+        {
+            if (manage_)
+            {
+                manage_(operation::destroy, *this, nullptr);
+            }
+        }
+
+        explicit operator bool() const
+        {
+            return ((invoker_t<signatures_t>::invoke_ != nullptr) || ...);
+        }
+
+    private:
+        void* context() const
+        {
+            return const_cast<void*>(static_cast<const void*>(&storage_));
+        }
+
+        template<typename callable_t>
+        static void manage(operation op, basic_delegate& dst, basic_delegate* src)
+        {
+            if constexpr (is_inline_v<callable_t>)
+            {
+                switch (op)
+                {
+                case operation::copy:
+                    ::new (static_cast<void*>(&dst.storage_)) callable_t(*reinterpret_cast<const callable_t*>(&src->storage_));
+                    break;
+                case operation::move:
+                    ::new (static_cast<void*>(&dst.storage_)) callable_t(std::move(*reinterpret_cast<callable_t*>(&src->storage_)));
+                    break;
+                case operation::destroy:
+                    reinterpret_cast<callable_t*>(&dst.storage_)->~callable_t();
+                    break;
+                }
+            }
+            else
+            {
+                auto& dstPtr = *reinterpret_cast<callable_t**>(&dst.storage_);
+                switch (op)
+                {
+                case operation::copy:
+                    dstPtr = new callable_t(**reinterpret_cast<callable_t**>(&src->storage_));
+                    break;
+                case operation::move:
+                    // Steal allocation, and leave source empty
+                    dstPtr = *reinterpret_cast<callable_t**>(&src->storage_);
+                    ((static_cast<invoker_t<signatures_t>&>(*src).invoke_ = nullptr), ...);
+                    src->manage_ = nullptr;
+                    break;
+                case operation::destroy:
+                    delete dstPtr;
+                    break;
+                }
+            }
+        }
+
+        std::aligned_storage_t<(inline_capacity < sizeof(void*) ? sizeof(void*) : inline_capacity), alignof(std::max_align_t)> storage_{};
+        manage_t manage_ = nullptr;
+    };
+
+    template<typename signature_t, std::size_t inline_capacity = PIPEABLE_DELEGATE_INLINE_CAPACITY>
+    using delegate = basic_delegate<inline_capacity, signature_t>;
+}
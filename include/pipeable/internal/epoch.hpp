@@ -0,0 +1,125 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <limits>
+
+namespace pipeable::impl
+{
+    /*
+    Epoch-based reclamation (process wide).
+    Readers pin the current epoch for the duration of a read, which costs a store to a thread owned cache line.
+    Writers publish a new object, then retire the old one tagged with 'advance()'. A retired object may be
+    destroyed once 'tag < min_active_epoch()', ie. no reader pinned before it was unpublished is still active.
+    Pinning is reentrant (eg. a receiver emitting to another generator), only the outermost pin is published.
+    */
+    class epoch_domain
+    {
+        static constexpr std::uint64_t quiescent = std::numeric_limits<std::uint64_t>::max();
+
+        // One per (active) thread, reused when threads exit. Records are never freed.
+        struct alignas(64) record
+        {
+            std::atomic<std::uint64_t> epoch{ quiescent };
+            std::atomic<bool> inUse{ true };
+            std::uint32_t depth = 0; // Only accessed by owning thread
+            record* next = nullptr;
+        };
+
+        struct record_owner
+        {
+            record_owner(epoch_domain& domain) :
+                rec(domain.acquire())
+            {}
+            ~record_owner()
+            {
+                rec->epoch.store(quiescent, std::memory_order_release);
+                rec->inUse.store(false, std::memory_order_release);
+            }
+            record* rec;
+        };
+
+    public:
+        class guard
+        {
+        public:
+            explicit guard(record& rec) :
+                rec_(rec)
+            {
+            }
+            guard(const guard&) = delete;
+            guard& operator=(const guard&) = delete;
+
+            ~guard()
+            {
+                if (--rec_.depth == 0)
+                {
+                    rec_.epoch.store(quiescent, std::memory_order_release);
+                }
+            }
+
+        private:
+            record& rec_;
+        };
+
+        static epoch_domain& instance()
+        {
+            static epoch_domain domain;
+            return domain;
+        }
+
+        // Enter read-side critical section. Objects loaded (seq_cst) while pinned stay alive until guard is destroyed.
+        guard pin()
+        {
+            thread_local record_owner owner{ *this };
+            auto& rec = *owner.rec;
+            if (rec.depth++ == 0)
+            {
+                // Must be globally visible before the protected pointer is loaded (hence seq_cst)
+                rec.epoch.store(epoch_.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+            }
+            return guard(rec);
+        }
+
+        // Call after an object is unpublished. Returns tag to retire it with.
+        std::uint64_t advance()
+        {
+            return epoch_.fetch_add(1, std::memory_order_seq_cst);
+        }
+
+        // Objects retired with a tag less than this can no longer be observed by any reader
+        std::uint64_t min_active_epoch() const
+        {
+            auto minEpoch = quiescent;
+            for (auto rec = records_.load(std::memory_order_acquire); rec; rec = rec->next)
+            {
+                const auto epoch = rec->epoch.load(std::memory_order_seq_cst);
+                minEpoch = epoch < minEpoch ? epoch : minEpoch;
+            }
+            return minEpoch;
+        }
+
+    private:
+        epoch_domain() = default;
+
+        record* acquire()
+        {
+            for (auto rec = records_.load(std::memory_order_acquire); rec; rec = rec->next)
+            {
+                bool expected = false;
+                if (!rec->inUse.load(std::memory_order_relaxed) && rec->inUse.compare_exchange_strong(expected, true, std::memory_order_acquire))
+                {
+                    return rec;
+                }
+            }
+
+            auto rec = new record();
+            rec->next = records_.load(std::memory_order_relaxed);
+            while (!records_.compare_exchange_weak(rec->next, rec, std::memory_order_release, std::memory_order_relaxed));
+            return rec;
+        }
+
+        std::atomic<std::uint64_t> epoch_{ 1 };
+        std::atomic<record*> records_{ nullptr };
+    };
+}
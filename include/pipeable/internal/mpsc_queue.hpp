@@ -0,0 +1,158 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace pipeable::impl
+{
+    inline constexpr std::size_t cache_line_size = 64;
+
+    constexpr std::size_t round_up_pow2(std::size_t value)
+    {
+        std::size_t result = 1;
+        while (result < value)
+        {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    /*
+    Bounded lock-free multi-producer, single-consumer queue (Vyukov style ring of sequenced slots).
+    Producers claim a slot with a CAS on 'tail', and publish it by bumping the slot sequence, so a full queue fails instead of blocking.
+    Capacity is rounded up to a power of two.
+    */
+    template<typename T>
+    class mpsc_queue
+    {
+        struct slot_t
+        {
+            std::atomic<std::size_t> sequence;
+            std::aligned_storage_t<sizeof(T), alignof(T)> storage;
+
+            T& value()
+            {
+                return *std::launder(reinterpret_cast<T*>(&storage));
+            }
+        };
+
+    public:
+        explicit mpsc_queue(std::size_t capacity) :
+            mask_(round_up_pow2(capacity < 2 ? 2 : capacity) - 1),
+            slots_(new slot_t[mask_ + 1])
+        {
+            for (std::size_t i = 0; i <= mask_; ++i)
+            {
+                slots_[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        mpsc_queue(const mpsc_queue&) = delete;
+        mpsc_queue& operator=(const mpsc_queue&) = delete;
+
+        ~mpsc_queue()
+        {
+            while (try_pop([](T&&) {}));
+        }
+
+        template<typename... args_t>
+        bool try_push(args_t&&... args)
+        {
+            auto pos = tail_.load(std::memory_order_relaxed);
+            while (true)
+            {
+                auto& slot = slots_[pos & mask_];
+                const auto sequence = slot.sequence.load(std::memory_order_acquire);
+                const auto diff = std::intptr_t(sequence) - std::intptr_t(pos);
+                if (diff == 0)
+                {
+                    if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    {
+                        ::new (static_cast<void*>(&slot.storage)) T(std::forward<args_t>(args)...);
+                        slot.sequence.store(pos + 1, std::memory_order_release);
+                        return true;
+                    }
+                }
+                else if (diff < 0)
+                {
+                    // Full
+                    return false;
+                }
+                else
+                {
+                    pos = tail_.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        // Pop one value (single consumer only), and pass it to 'consumer' as an r-value
+        template<typename consumer_t>
+        bool try_pop(consumer_t&& consumer)
+        {
+            const auto pos = head_.load(std::memory_order_relaxed);
+            auto& slot = slots_[pos & mask_];
+            if (slot.sequence.load(std::memory_order_acquire) != pos + 1)
+            {
+                return false;
+            }
+            std::forward<consumer_t>(consumer)(std::move(slot.value()));
+            slot.value().~T();
+            slot.sequence.store(pos + mask_ + 1, std::memory_order_release);
+            head_.store(pos + 1, std::memory_order_relaxed);
+            return true;
+        }
+
+        // Pop up to 'max' values (single consumer only), returns count popped
+        template<typename consumer_t>
+        std::size_t pop_batch(consumer_t&& consumer, std::size_t max)
+        {
+            std::size_t popped = 0;
+            while (popped < max && try_pop(consumer))
+            {
+                ++popped;
+            }
+            return popped;
+        }
+
+        // Copy as many of 'values' as fit, returns count pushed
+        std::size_t push_batch(const T* values, std::size_t count)
+        {
+            std::size_t pushed = 0;
+            while (pushed < count && try_push(values[pushed]))
+            {
+                ++pushed;
+            }
+            return pushed;
+        }
+
+        bool empty() const
+        {
+            const auto pos = head_.load(std::memory_order_relaxed);
+            return slots_[pos & mask_].sequence.load(std::memory_order_seq_cst) != pos + 1;
+        }
+
+        // Approximate when producers/consumer are active
+        std::size_t size() const
+        {
+            const auto head = head_.load(std::memory_order_relaxed);
+            const auto tail = tail_.load(std::memory_order_relaxed);
+            return tail > head ? tail - head : 0;
+        }
+
+        std::size_t capacity() const
+        {
+            return mask_ + 1;
+        }
+
+    private:
+        const std::size_t mask_;
+        std::unique_ptr<slot_t[]> slots_;
+        alignas(cache_line_size) std::atomic<std::size_t> tail_{ 0 };
+        alignas(cache_line_size) std::atomic<std::size_t> head_{ 0 };
+    };
+}
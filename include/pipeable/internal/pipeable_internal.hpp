@@ -1,5 +1,7 @@
 #pragma once
 
+#include <functional>
+#include <memory>
 #include <type_traits>
 #include <tuple>
 #include <utility>
@@ -13,6 +15,18 @@ namespace pipeable
         struct pipe_tag {};
         struct custom_pipeable_tag {};
         struct pipe_interceptor_tag {};
+        // Types constructible from a pipe themselves (eg. any_pipe), which a pipe doesn't (ambiguously) convert to
+        struct pipe_holder_tag {};
+
+        template<typename callable_base_t>
+        struct interceptor;
+
+        // Interceptors made by 'make_interceptor' are detected by type rather than by (tag) base, so that a pipe holding several of them stays empty
+        template<typename T>
+        constexpr bool is_interceptor_wrapper_v = false;
+
+        template<typename callable_base_t>
+        constexpr bool is_interceptor_wrapper_v<interceptor<callable_base_t>> = true;
     }
 
     namespace meta
@@ -24,12 +38,52 @@ namespace pipeable
         constexpr bool is_custom_pipeable_v = (std::is_base_of_v<impl::custom_pipeable_tag, std::decay_t<Ts>> && ...);
 
         template<typename... Ts>
-        constexpr bool is_interceptor_v = (std::is_base_of_v<impl::pipe_interceptor_tag, std::decay_t<Ts>> && ...);
+        constexpr bool is_interceptor_v = ((std::is_base_of_v<impl::pipe_interceptor_tag, std::decay_t<Ts>> || impl::is_interceptor_wrapper_v<std::decay_t<Ts>>) && ...);
+
+        namespace details
+        {
+            template<typename T>
+            struct referenced
+            {
+                using type = T;
+                static constexpr bool is_indirect = false;
+            };
+            template<typename T>
+            struct referenced<T*>
+            {
+                using type = T;
+                static constexpr bool is_indirect = true;
+            };
+            template<typename T>
+            struct referenced<std::reference_wrapper<T>>
+            {
+                using type = T;
+                static constexpr bool is_indirect = true;
+            };
+            template<typename T>
+            struct referenced<std::shared_ptr<T>>
+            {
+                using type = T;
+                static constexpr bool is_indirect = true;
+            };
+        }
+
+        // Pointers, std::reference_wrapper & std::shared_ptr refer to the callable they hold (which is never copied along with them)
+        template<typename T>
+        constexpr bool is_indirect_v = details::referenced<std::decay_t<T>>::is_indirect;
+
+        // Type of callable referred to (or T itself, if not indirect)
+        template<typename T>
+        using referenced_t = typename details::referenced<std::decay_t<T>>::type;
 
         template<typename T>
         constexpr decltype(auto) deref_if_ptr(T&& obj)
         {
-            if constexpr (std::is_pointer_v<std::decay_t<T>>)
+            if constexpr (std::is_same_v<std::decay_t<T>, std::reference_wrapper<referenced_t<T>>>)
+            {
+                return obj.get();
+            }
+            else if constexpr (is_indirect_v<T>)
             {
                 return *FWD(obj);
             }
@@ -72,69 +126,76 @@ namespace pipeable
 
     namespace impl
     {
-        // Wrapper taking care of invocation of tail + head pair.
-        // If tail & head are not interceptors: tail(head(args...));
-        // If head is interceptor: head(tail, args...);
-        template<typename tail_t, typename head_t>
-        struct invoke_pair
+        // Stateless callables (empty & non final) are stored as base, taking no space (empty base optimization), others as member.
+        // Note: like any base, 2 stages of the same empty type can't share an address, so such a pipe takes 1 byte per duplicate.
+        template<std::size_t index, typename callable_t, bool = std::is_empty_v<callable_t> && !std::is_final_v<callable_t>>
+        struct callable_leaf
         {
-            template<typename T1, typename T2>
-            invoke_pair(T1&& tail, T2&& head) :
-                tail(FWD(tail)),
-                head(FWD(head))
+            template<typename T>
+            constexpr callable_leaf(std::in_place_t, T&& callable) :
+                callable(FWD(callable))
             {
             }
+            callable_leaf() = default;
 
-            // If head & tail are callable, invoke as: tail(head(args...))
-            template<typename... args_t, typename T = tail_t, typename H = head_t,
-                concepts::IsNotInterceptor<T> = nullptr,
-                concepts::IsNotInterceptor<H> = nullptr>
-            decltype(auto) operator()(args_t&&... args)
-            {
-                return tail(head(FWD(args)...));
-            }
+            constexpr callable_t& get() { return callable; }
+            constexpr const callable_t& get() const { return callable; }
+
+            callable_t callable;
+        };
 
-            // If head is interceptor & tail is callable, invoke as: interceptor(tail, args...)
-            template<typename... args_t, typename T = tail_t, typename H = head_t,
-                concepts::IsInterceptor<H> = nullptr,
-                concepts::IsNotInterceptor<T> = nullptr>
-            decltype(auto) operator()(args_t&&... args)
+        template<std::size_t index, typename callable_t>
+        struct callable_leaf<index, callable_t, true> : std::remove_cv_t<callable_t>
+        {
+            template<typename T>
+            constexpr callable_leaf(std::in_place_t, T&& callable) :
+                std::remove_cv_t<callable_t>(FWD(callable))
             {
-                return head(tail, FWD(args)...);
             }
+            callable_leaf() = default;
+
+            constexpr callable_t& get() { return *this; }
+            constexpr const callable_t& get() const { return *this; }
+        };
+
+        // Flat (non-recursive) storage of callables, one base per callable. Cheaper to instantiate than std::tuple.
+        template<typename indexes_t, typename... callables_t>
+        struct callable_storage;
 
-            template<typename... args_t>
-            static constexpr bool is_invocable()
+        template<std::size_t... indexes, typename... callables_t>
+        struct callable_storage<std::index_sequence<indexes...>, callables_t...> : callable_leaf<indexes, callables_t>...
+        {
+            template<typename... Ts>
+            constexpr callable_storage(std::in_place_t, Ts&&... callables) :
+                callable_leaf<indexes, callables_t>(std::in_place, FWD(callables))...
             {
-                using head_t_ = std::remove_pointer_t<head_t>;
-                if constexpr (meta::is_interceptor_v<head_t_>)
-                {
-                    return std::is_invocable_v<head_t_, tail_t, args_t...>;
-                }
-                else
-                {
-                    return std::is_invocable_v<head_t_, args_t...>;
-                }
             }
-
-            tail_t tail;
-            head_t head;
+            callable_storage() = default;
         };
-        // Deduction guide to figure out callable types
-        template<typename T1, typename T2>
-        invoke_pair(T1&& tail, T2&& head)
-            ->
-            invoke_pair<T1, T2>;
-    }
 
-    namespace invocation
-    {
-        template<typename... args_t>
-        inline constexpr auto make_index_sequence(std::tuple<args_t...> = {})
+        template<typename... callables_t>
+        using callable_storage_t = callable_storage<std::index_sequence_for<callables_t...>, callables_t...>;
+
+        // Access callable at index. Leaf type is deduced from (unique) base, so no recursion is required.
+        template<std::size_t index, typename callable_t, bool compressed>
+        constexpr callable_t& get(callable_leaf<index, callable_t, compressed>& leaf)
         {
-            return std::index_sequence_for<args_t...>();
+            return leaf.get();
         }
+        template<std::size_t index, typename callable_t, bool compressed>
+        constexpr const callable_t& get(const callable_leaf<index, callable_t, compressed>& leaf)
+        {
+            return leaf.get();
+        }
+        template<std::size_t index, typename callable_t, bool compressed>
+        constexpr callable_t&& get(callable_leaf<index, callable_t, compressed>&& leaf)
+        {
+            return std::move(leaf.get());
+        }
+    }
 
+    namespace invocation
+    {
         template<typename arg_t>
         constexpr decltype(auto) invoke(arg_t&& arg)
         {
@@ -150,26 +211,57 @@ namespace pipeable
 
         template<typename head_t, typename arg_t,
             concepts::IsNotPipe<head_t> = nullptr>
-        constexpr decltype(auto) invoke(head_t&& head, arg_t&& arg);
-
-        template<typename tail_t, typename head_t, typename... rest_t,
-            concepts::IsNotPipe<tail_t> = nullptr,
-            concepts::IsNotPipe<head_t> = nullptr>
-            constexpr decltype(auto) invoke(tail_t&& tail, head_t&& head, rest_t&&... rest);
+        constexpr decltype(auto) invoke(head_t&& head, arg_t&& arg)
+        {
+           return meta::deref_if_ptr(FWD(head))(invoke(FWD(arg)));
+        }
 
-        template<typename composite_t, std::size_t... indexes, typename... args_t,
-            concepts::IsPipe<composite_t> = nullptr>
-        inline constexpr decltype(auto) invoke(composite_t&& pipe, std::index_sequence<indexes...>, args_t&&... args)
+        namespace details
         {
-            // Reverse order to get tail...head which will be composed to: tail(...(head(args)));
-            return invoke(std::get<(sizeof...(indexes) - 1 - indexes)>(FWD(pipe).callables)..., FWD(args)...);
+            template<std::size_t index, typename composite_t, typename... args_t>
+            constexpr decltype(auto) invoke_from(composite_t& pipe, args_t&&... args);
+
+            // Represents the pipeline downstream of an interceptor (stage 'index' and onwards)
+            template<std::size_t index, typename composite_t>
+            struct downstream
+            {
+                template<typename... args_t>
+                constexpr decltype(auto) operator()(args_t&&... args) const
+                {
+                    return invoke_from<index>(pipe, FWD(args)...);
+                }
+
+                composite_t& pipe;
+            };
+
+            // Invoke stage 'index' with args, and forward the result to the next stage.
+            // If stage is interceptor: stage(downstream, args...);
+            // Else: next_stage(stage(args...));
+            template<std::size_t index, typename composite_t, typename... args_t>
+            constexpr decltype(auto) invoke_from(composite_t& pipe, args_t&&... args)
+            {
+                auto&& stage = meta::deref_if_ptr(impl::get<index>(pipe.callables));
+                if constexpr (index + 1 == std::tuple_size_v<typename std::decay_t<composite_t>::callables_tuple_t>)
+                {
+                    return stage(FWD(args)...);
+                }
+                else if constexpr (meta::is_interceptor_v<decltype(stage)>)
+                {
+                    return stage(downstream<index + 1, composite_t>{ pipe }, FWD(args)...);
+                }
+                else
+                {
+                    return invoke_from<index + 1>(pipe, stage(FWD(args)...));
+                }
+            }
         }
 
         template<typename composite_t, typename... args_t, 
             concepts::IsPipe<composite_t> = nullptr>
         inline constexpr decltype(auto) invoke(composite_t&& pipe, args_t&&... args)
         {
-            return invoke(FWD(pipe), make_index_sequence(FWD(pipe).callables), FWD(args)...);
+            // Stages are invoked in order head...tail, composed as: tail(...(head(args)));
+            return details::invoke_from<0>(pipe, invoke(FWD(args))...);
         }
     }
 
@@ -183,41 +275,45 @@ namespace pipeable
                 void operator()(args_t&&...){}
             };
 
-            template<typename arg_t, typename head_t, typename... tails_t>
-            constexpr bool is_invocable_impl()
+            // If head is interceptor, check as: head(downstream, args...)
+            // Else: head(args...)
+            template<typename head_t, typename... args_t>
+            constexpr bool is_head_invocable()
             {
-                if constexpr (std::is_void_v<arg_t>)
+                using head_t_ = meta::referenced_t<head_t>;
+                if constexpr (meta::is_interceptor_v<head_t_>)
                 {
-                    return std::is_invocable_v<head_t>;
+                    return std::is_invocable_v<head_t_, no_op_callable, args_t...>;
                 }
                 else
                 {
-                    using invoker_t = impl::invoke_pair<no_op_callable, std::decay_t<head_t>>;
-
-                    if constexpr (std::is_invocable_v<arg_t>)
-                    {
-                        using arg_result_t = std::invoke_result_t<arg_t>;
-                        return invoker_t::template is_invocable<arg_result_t>();
-                    }
-                    else
-                    {
-                        return invoker_t::template is_invocable<arg_t>();
-                    }
+                    return std::is_invocable_v<head_t_, args_t...>;
                 }
             }
 
-            template<typename tuple_t, typename arg_t, std::size_t... indexes>
-            constexpr bool is_invocable_impl(std::index_sequence<indexes...>)
+            template<typename arg_t, typename head_t>
+            constexpr bool is_invocable_impl()
             {
-                return is_invocable_impl<arg_t, std::tuple_element_t<indexes, tuple_t>...>();
+                if constexpr (std::is_void_v<arg_t>)
+                {
+                    return std::is_invocable_v<head_t>;
+                }
+                else if constexpr (std::is_invocable_v<arg_t>)
+                {
+                    using arg_result_t = std::invoke_result_t<arg_t>;
+                    return is_head_invocable<head_t, arg_result_t>();
+                }
+                else
+                {
+                    return is_head_invocable<head_t, arg_t>();
+                }
             }
 
-            template<typename composite_t, typename arg_t, concepts::IsPipe<composite_t> = nullptr>
+            template<typename composite_t, typename arg_t = void, concepts::IsPipe<composite_t> = nullptr>
             constexpr bool is_invocable()
             {
-                using tuples_t = typename std::decay_t<composite_t>::callables_tuple_t;
-                using sequence_t = decltype(invocation::make_index_sequence(std::declval<tuples_t>()));
-                return is_invocable_impl<tuples_t, arg_t>(sequence_t{});
+                // Like a single callable, a pipe is considered invocable with arg if its head is
+                return is_invocable_impl<arg_t, typename std::decay_t<composite_t>::head_t>();
             }
 
             template<typename callable_t, typename arg_t = void, concepts::IsNotPipe<callable_t> = nullptr>
@@ -263,15 +359,17 @@ namespace pipeable
 
             template<typename... Ts, concepts::IsNotPipe<Ts...> = nullptr>
             composite_pipe(Ts&&... callables) :
-                callables(FWD(callables)...)
+                callables(std::in_place, FWD(callables)...)
             {
             }
             composite_pipe() = default;
             composite_pipe(const composite_pipe& rhs) = default;
             composite_pipe(composite_pipe&& rhs) = default;
 
-            template<typename T>
-            operator T() const
+            // Conversion to a callable type (eg. std::function), copying all stages
+            template<typename T,
+                typename = std::enable_if_t<!std::is_base_of_v<impl::pipe_holder_tag, T>>>
+            operator T() const &
             {
                 return [pipe = *this](auto&&... args)
                 {
@@ -279,7 +377,18 @@ namespace pipeable
                 };
             }
 
-            callables_tuple_t callables;
+            // Conversion of a temporary (or std::move'd) pipe, moving all stages
+            template<typename T,
+                typename = std::enable_if_t<!std::is_base_of_v<impl::pipe_holder_tag, T>>>
+            operator T() &&
+            {
+                return [pipe = std::move(*this)](auto&&... args)
+                {
+                    return invocation::invoke(pipe, FWD(args)...);
+                };
+            }
+
+            callable_storage_t<callables_t...> callables;
         };
 
         // Deduction guide to figure out callable types
@@ -288,9 +397,23 @@ namespace pipeable
             ->
             composite_pipe<std::remove_reference_t<T>, std::remove_reference_t<Ts>...>;
 
-        // Wraps a lambda in a new type tagged as an 'interceptor' (used by type traits)
+        // Non-owning view of a pipe (see 'by_ref'), invocable like the pipe itself
+        template<typename composite_t>
+        struct pipe_ref
+        {
+            template<typename... args_t,
+                concepts::IsInvocable<composite_t, args_t...> = nullptr>
+            constexpr decltype(auto) operator()(args_t&&... args) const
+            {
+                return invocation::invoke(*pipe, FWD(args)...);
+            }
+
+            composite_t* pipe;
+        };
+
+        // Wraps a lambda in a new type detected as an 'interceptor' (by type traits)
         template<typename callable_base_t>
-        struct interceptor : impl::pipe_interceptor_tag, callable_base_t
+        struct interceptor : callable_base_t
         {
             interceptor(callable_base_t&& callable) :
                 callable_base_t(std::move(callable))
@@ -300,53 +423,88 @@ namespace pipeable
 
     namespace assembly
     {
-        template<typename head_t, std::size_t... head_indexes, typename callable_t>
-        inline constexpr decltype(auto) compose(head_t&& head, std::index_sequence<head_indexes...>, callable_t&& tail)
-        {
-            return impl::composite_pipe(std::get<head_indexes>(FWD(head).callables)..., tail);
-        }
-
-        template<typename callable_t, typename tail_t, std::size_t... tail_indexes>
-        inline constexpr decltype(auto) compose(callable_t&& head, tail_t&& tail, std::index_sequence<tail_indexes...>)
-        {
-            return impl::composite_pipe(FWD(head), std::get<tail_indexes>(FWD(tail).callables)...);
-        }
-
-        template<typename head_t, std::size_t... head_indexes, typename tail_t, std::size_t... tail_indexes>
-        inline constexpr decltype(auto) compose(head_t&& head, std::index_sequence<head_indexes...>, tail_t&& tail, std::index_sequence<tail_indexes...>)
-        {
-            return impl::composite_pipe(std::get<head_indexes>(FWD(head).callables)..., std::get<tail_indexes>(FWD(tail).callables)...);
-        }
-
-        template<typename head_t, typename tail_t>
-        constexpr decltype(auto) compose(head_t&& head, tail_t&& tail)
+        namespace details
         {
-            // Callable -> Callable
-            if constexpr (!meta::is_pipe_v<head_t> && !meta::is_pipe_v<tail_t>)
+            template<typename callable_t>
+            constexpr std::size_t callable_count()
             {
-                return impl::composite_pipe(FWD(head), FWD(tail));
+                if constexpr (meta::is_pipe_v<callable_t>)
+                {
+                    return std::tuple_size_v<typename std::decay_t<callable_t>::callables_tuple_t>;
+                }
+                else
+                {
+                    return 1;
+                }
             }
-            // Callable -> Pipe
-            else if constexpr (!meta::is_pipe_v<head_t> && meta::is_pipe_v<tail_t>)
+
+            // Maps each callable of the flattened (composed) pipe to its argument index & index within that argument
+            template<typename... callables_t>
+            struct flat_indexes
             {
-                return compose(FWD(head), FWD(tail), invocation::make_index_sequence(tail.callables));
-            }
-            // Pipe -> Callable
-            else if constexpr (meta::is_pipe_v<head_t> && !meta::is_pipe_v<tail_t>)
+                static constexpr std::size_t size = (callable_count<callables_t>() + ...);
+
+                struct indexes_t
+                {
+                    std::size_t argument[size];
+                    std::size_t element[size];
+                };
+
+                static constexpr indexes_t make()
+                {
+                    constexpr std::size_t counts[] = { callable_count<callables_t>()... };
+                    indexes_t indexes{};
+                    std::size_t flatIndex = 0;
+                    for (std::size_t arg = 0; arg < sizeof...(callables_t); ++arg)
+                    {
+                        for (std::size_t elem = 0; elem < counts[arg]; ++elem, ++flatIndex)
+                        {
+                            indexes.argument[flatIndex] = arg;
+                            indexes.element[flatIndex] = elem;
+                        }
+                    }
+                    return indexes;
+                }
+
+                static constexpr indexes_t value = make();
+            };
+
+            template<std::size_t element, typename callable_t>
+            constexpr decltype(auto) get_callable(callable_t&& callable)
             {
-                return compose(FWD(head), invocation::make_index_sequence(head.callables), FWD(tail));
+                if constexpr (meta::is_pipe_v<callable_t>)
+                {
+                    return impl::get<element>(FWD(callable).callables);
+                }
+                else
+                {
+                    return FWD(callable);
+                }
             }
-            // Pipe -> Pipe
-            else if constexpr (meta::is_pipe_v<head_t> && meta::is_pipe_v<tail_t>)
+
+            template<typename indexes_t, typename args_tuple_t, std::size_t... flat_indexes>
+            constexpr decltype(auto) compose_flat(args_tuple_t&& args, std::index_sequence<flat_indexes...>)
             {
-                return compose(FWD(head), invocation::make_index_sequence(head.callables), FWD(tail), invocation::make_index_sequence(tail.callables));
+                return impl::composite_pipe(
+                    get_callable<indexes_t::value.element[flat_indexes]>(std::get<indexes_t::value.argument[flat_indexes]>(std::move(args)))...);
             }
         }
 
+        // Flatten all callables & pipes (head...tail) into a single composite_pipe in one step
         template<typename head_t, typename tail_t, typename... tails_t>
         constexpr decltype(auto) compose(head_t&& head, tail_t&& tail, tails_t&&... tails)
         {
-            return compose(compose(FWD(head), FWD(tail)), FWD(tails)...);
+            using indexes_t = details::flat_indexes<head_t, tail_t, tails_t...>;
+            return details::compose_flat<indexes_t>(std::forward_as_tuple(FWD(head), FWD(tail), FWD(tails)...), std::make_index_sequence<indexes_t::size>());
+        }
+
+        // Callable invoking 'pipe' in place, so it can be converted (eg. to std::function) or registered without copying any stage.
+        // 'pipe' must outlive the returned view.
+        template<typename composite_t,
+            concepts::IsPipe<composite_t> = nullptr>
+        constexpr auto by_ref(composite_t& pipe)
+        {
+            return impl::pipe_ref<composite_t>{ &pipe };
         }
 
         template<typename callable_t>
@@ -356,25 +514,4 @@ namespace pipeable
             return impl::interceptor(std::move(callable));
         }
     }
-}
-
-namespace pipeable
-{
-    namespace invocation
-    {
-        template<typename tail_t, typename head_t, typename... rest_t,
-            concepts::IsNotPipe<tail_t>,
-            concepts::IsNotPipe<head_t>>
-        constexpr decltype(auto) invoke(tail_t&& tail, head_t&& head, rest_t&&... rest)
-        {
-            return invoke(impl::invoke_pair(meta::deref_if_ptr(FWD(tail)), meta::deref_if_ptr(FWD(head))), FWD(rest)...);
-        }
-
-        template<typename head_t, typename arg_t,
-            concepts::IsNotPipe<head_t>>
-        constexpr decltype(auto) invoke(head_t&& head, arg_t&& arg)
-        {
-           return meta::deref_if_ptr(FWD(head))(invoke(FWD(arg)));
-        }
-    }
 }
\ No newline at end of file
@@ -0,0 +1,234 @@
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace pipeable::impl
+{
+    // Identifies a single registration in a receiver_list.
+    // 'generation' makes a stale id (of an already removed receiver) a no-op, even if its slot has been reused.
+    struct receiver_id
+    {
+        static constexpr std::uint32_t npos = std::uint32_t(-1);
+
+        std::uint32_t slot = npos;
+        std::uint32_t generation = 0;
+
+        explicit operator bool() const
+        {
+            return slot != npos;
+        }
+    };
+
+    /*
+    Receivers stored as structure-of-arrays: dispatch walks the dense 'invokers' only,
+    and removal by identifier walks the dense 'identifiers' only.
+    Each registration owns a slot mapping its receiver_id to the current position in the dense arrays,
+    so removal by id is an O(1) swap-remove (the last receiver takes the place of the removed one).
+    Thus the order of receivers is only preserved as long as none is removed.
+    Insertion leaves the list unchanged if it throws (all growth is reserved first), and erasure never allocates.
+    Several modifications are made atomic by 'transact', which journals them to be undone if one throws (so no copy is needed).
+    */
+    template<typename invoker_t>
+    class receiver_list
+    {
+        struct slot_t
+        {
+            std::uint32_t position = receiver_id::npos;
+            std::uint32_t generation = 0;
+            // Next free slot, while this one is free
+            std::uint32_t nextFree = receiver_id::npos;
+        };
+
+        // Undo record of a modification: an insertion (position is npos), or an erasure of the receiver held
+        struct change_t
+        {
+            std::uint32_t slot = receiver_id::npos;
+            std::uint32_t position = receiver_id::npos;
+            std::uint32_t generation = 0;
+            invoker_t invoker;
+            const void* identifier = nullptr;
+        };
+
+    public:
+        // Apply 'callback(list)', undoing all of its modifications if it throws
+        template<typename callback_t>
+        void transact(callback_t&& callback)
+        {
+            journaling_ = true;
+            try
+            {
+                std::forward<callback_t>(callback)(*this);
+            }
+            catch (...)
+            {
+                rollback();
+                throw;
+            }
+            changes_.clear();
+            journaling_ = false;
+        }
+
+        receiver_id insert(const void* identifier, invoker_t&& invoker)
+        {
+            if (journaling_)
+            {
+                reserve_one_more(changes_);
+            }
+            reserve_one_more(invokers_);
+            reserve_one_more(identifiers_);
+            reserve_one_more(positionSlots_);
+            if (freeSlot_ == receiver_id::npos)
+            {
+                reserve_one_more(slots_);
+            }
+
+            std::uint32_t slot;
+            if (freeSlot_ == receiver_id::npos)
+            {
+                slot = static_cast<std::uint32_t>(slots_.size());
+                slots_.emplace_back();
+            }
+            else
+            {
+                slot = freeSlot_;
+                freeSlot_ = slots_[slot].nextFree;
+            }
+
+            slots_[slot].position = static_cast<std::uint32_t>(invokers_.size());
+            invokers_.push_back(std::move(invoker));
+            identifiers_.push_back(identifier);
+            positionSlots_.push_back(slot);
+            if (journaling_)
+            {
+                changes_.push_back({ slot });
+            }
+            return { slot, slots_[slot].generation };
+        }
+
+        void erase(receiver_id id)
+        {
+            if (id.slot < slots_.size() && slots_[id.slot].generation == id.generation && slots_[id.slot].position != receiver_id::npos)
+            {
+                erase_at(slots_[id.slot].position);
+            }
+        }
+
+        // Remove all receivers registered with 'identifier' (non-null)
+        void erase(const void* identifier)
+        {
+            for (auto position = identifiers_.size(); position-- > 0;)
+            {
+                if (identifiers_[position] == identifier)
+                {
+                    erase_at(position);
+                }
+            }
+        }
+
+        const std::vector<invoker_t>& invokers() const
+        {
+            return invokers_;
+        }
+
+        std::size_t size() const
+        {
+            return invokers_.size();
+        }
+
+    private:
+        template<typename T>
+        static void reserve_one_more(std::vector<T>& values)
+        {
+            if (values.size() == values.capacity())
+            {
+                values.reserve(values.empty() ? 1 : 2 * values.size());
+            }
+        }
+
+        // Only allocates to journal the erasure, before modifying anything
+        void erase_at(std::size_t position)
+        {
+            const auto last = invokers_.size() - 1;
+            const auto removedSlot = positionSlots_[position];
+            if (journaling_)
+            {
+                reserve_one_more(changes_);
+                changes_.push_back({ removedSlot, static_cast<std::uint32_t>(position), slots_[removedSlot].generation, std::move(invokers_[position]), identifiers_[position] });
+            }
+            if (position != last)
+            {
+                invokers_[position] = std::move(invokers_[last]);
+                identifiers_[position] = identifiers_[last];
+                positionSlots_[position] = positionSlots_[last];
+                slots_[positionSlots_[position]].position = static_cast<std::uint32_t>(position);
+            }
+            invokers_.pop_back();
+            identifiers_.pop_back();
+            positionSlots_.pop_back();
+
+            // Invalidate outstanding ids before the slot is reused
+            slots_[removedSlot].position = receiver_id::npos;
+            ++slots_[removedSlot].generation;
+            slots_[removedSlot].nextFree = freeSlot_;
+            freeSlot_ = removedSlot;
+        }
+
+        // Undo journaled changes, latest first, so each finds the list as it left it.
+        // Nothing allocates: erasures only shrank the arrays, and a slot freed by erasure is still at the head of the free list.
+        void rollback() noexcept
+        {
+            for (auto change = changes_.rbegin(); change != changes_.rend(); ++change)
+            {
+                auto& slot = slots_[change->slot];
+                if (change->position == receiver_id::npos)
+                {
+                    // The inserted receiver is the last, its slot is freed (ids handed out are invalidated)
+                    invokers_.pop_back();
+                    identifiers_.pop_back();
+                    positionSlots_.pop_back();
+                    slot.position = receiver_id::npos;
+                    ++slot.generation;
+                    slot.nextFree = freeSlot_;
+                    freeSlot_ = change->slot;
+                }
+                else
+                {
+                    // The receiver which took the place of the erased one moves back to the end
+                    freeSlot_ = slot.nextFree;
+                    slot.position = change->position;
+                    slot.generation = change->generation;
+                    if (change->position == invokers_.size())
+                    {
+                        invokers_.push_back(std::move(change->invoker));
+                        identifiers_.push_back(change->identifier);
+                        positionSlots_.push_back(change->slot);
+                    }
+                    else
+                    {
+                        invokers_.push_back(std::move(invokers_[change->position]));
+                        identifiers_.push_back(identifiers_[change->position]);
+                        positionSlots_.push_back(positionSlots_[change->position]);
+                        slots_[positionSlots_.back()].position = static_cast<std::uint32_t>(invokers_.size() - 1);
+                        invokers_[change->position] = std::move(change->invoker);
+                        identifiers_[change->position] = change->identifier;
+                        positionSlots_[change->position] = change->slot;
+                    }
+                }
+            }
+            changes_.clear();
+            journaling_ = false;
+        }
+
+        std::vector<invoker_t> invokers_;
+        std::vector<const void*> identifiers_;
+        std::vector<std::uint32_t> positionSlots_;
+        std::vector<slot_t> slots_;
+        // Free slots are linked through 'slot_t::nextFree', so erasure never allocates
+        std::uint32_t freeSlot_ = receiver_id::npos;
+        // Journal of the ongoing 'transact'
+        std::vector<change_t> changes_;
+        bool journaling_ = false;
+    };
+}
@@ -0,0 +1,288 @@
+#pragma once
+
+#include <pipeable/internal/mpsc_queue.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+namespace pipeable::impl
+{
+    template<typename T>
+    struct ring_storage
+    {
+        std::aligned_storage_t<sizeof(T), alignof(T)> storage;
+
+        T& value()
+        {
+            return *std::launder(reinterpret_cast<T*>(&storage));
+        }
+    };
+
+    /*
+    Bounded lock-free single-producer, single-consumer ring.
+    Each side owns a cache line holding its index and a cached copy of the other side's index,
+    so the shared index is only re-read when the cached one suggests the ring is full (or empty).
+    Batches are published (and released) with a single store.
+    Capacity is rounded up to a power of two.
+    */
+    template<typename T>
+    class spsc_ring
+    {
+    public:
+        explicit spsc_ring(std::size_t capacity) :
+            mask_(round_up_pow2(capacity < 2 ? 2 : capacity) - 1),
+            slots_(new ring_storage<T>[mask_ + 1])
+        {}
+
+        spsc_ring(const spsc_ring&) = delete;
+        spsc_ring& operator=(const spsc_ring&) = delete;
+
+        ~spsc_ring()
+        {
+            while (pop_batch([](T&&) {}, capacity()));
+        }
+
+        template<typename... args_t>
+        bool try_push(args_t&&... args)
+        {
+            const auto tail = producer_.index.load(std::memory_order_relaxed);
+            if (free_slots(tail, 1) == 0)
+            {
+                return false;
+            }
+            ::new (static_cast<void*>(&slots_[tail & mask_].storage)) T(std::forward<args_t>(args)...);
+            producer_.index.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Copy as many of 'values' as fit, returns count pushed
+        std::size_t push_batch(const T* values, std::size_t count)
+        {
+            const auto tail = producer_.index.load(std::memory_order_relaxed);
+            const auto pushed = std::min(count, free_slots(tail, count));
+            for (std::size_t i = 0; i < pushed; ++i)
+            {
+                ::new (static_cast<void*>(&slots_[(tail + i) & mask_].storage)) T(values[i]);
+            }
+            if (pushed)
+            {
+                producer_.index.store(tail + pushed, std::memory_order_release);
+            }
+            return pushed;
+        }
+
+        // Pass up to 'max' values to 'consumer' (as r-values), returns count popped
+        template<typename consumer_t>
+        std::size_t pop_batch(consumer_t&& consumer, std::size_t max)
+        {
+            const auto head = consumer_.index.load(std::memory_order_relaxed);
+            auto available = consumer_.cached - head;
+            if (available < max)
+            {
+                consumer_.cached = producer_.index.load(std::memory_order_acquire);
+                available = consumer_.cached - head;
+            }
+            const auto popped = std::min(max, available);
+            for (std::size_t i = 0; i < popped; ++i)
+            {
+                auto& value = slots_[(head + i) & mask_].value();
+                consumer(std::move(value));
+                value.~T();
+            }
+            if (popped)
+            {
+                consumer_.index.store(head + popped, std::memory_order_release);
+            }
+            return popped;
+        }
+
+        bool empty() const
+        {
+            return consumer_.index.load(std::memory_order_seq_cst) == producer_.index.load(std::memory_order_seq_cst);
+        }
+
+        // Approximate when producer/consumer are active
+        std::size_t size() const
+        {
+            const auto head = consumer_.index.load(std::memory_order_relaxed);
+            const auto tail = producer_.index.load(std::memory_order_relaxed);
+            return tail > head ? tail - head : 0;
+        }
+
+        std::size_t capacity() const
+        {
+            return mask_ + 1;
+        }
+
+    private:
+        std::size_t free_slots(std::size_t tail, std::size_t wanted)
+        {
+            auto free = capacity() - (tail - producer_.cached);
+            if (free < wanted)
+            {
+                producer_.cached = consumer_.index.load(std::memory_order_acquire);
+                free = capacity() - (tail - producer_.cached);
+            }
+            return free;
+        }
+
+        // Index written by one side, with that side's cache of the other side's index
+        struct alignas(cache_line_size) side_t
+        {
+            std::atomic<std::size_t> index{ 0 };
+            std::size_t cached = 0;
+        };
+
+        const std::size_t mask_;
+        std::unique_ptr<ring_storage<T>[]> slots_;
+        side_t producer_;
+        side_t consumer_;
+    };
+
+    /*
+    Bounded lock-free multi-producer, multi-consumer ring (Vyukov style, as mpsc_queue, with a CAS on both indexes).
+    A batch claims a contiguous range of slots with a single CAS, provided the last slot of the range is ready.
+    Earlier slots of the range may still be in use by a thread that claimed them before (and is about to finish), which is waited for.
+    Capacity is rounded up to a power of two.
+    */
+    template<typename T>
+    class mpmc_ring
+    {
+        struct slot_t : ring_storage<T>
+        {
+            std::atomic<std::size_t> sequence;
+        };
+
+    public:
+        explicit mpmc_ring(std::size_t capacity) :
+            mask_(round_up_pow2(capacity < 2 ? 2 : capacity) - 1),
+            slots_(new slot_t[mask_ + 1])
+        {
+            for (std::size_t i = 0; i <= mask_; ++i)
+            {
+                slots_[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        mpmc_ring(const mpmc_ring&) = delete;
+        mpmc_ring& operator=(const mpmc_ring&) = delete;
+
+        ~mpmc_ring()
+        {
+            while (pop_batch([](T&&) {}, capacity()));
+        }
+
+        template<typename... args_t>
+        bool try_push(args_t&&... args)
+        {
+            const auto tail = claim(tail_, 1, 0);
+            if (tail.second == 0)
+            {
+                return false;
+            }
+            auto& slot = slots_[tail.first & mask_];
+            ::new (static_cast<void*>(&slot.storage)) T(std::forward<args_t>(args)...);
+            slot.sequence.store(tail.first + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Copy as many of 'values' as fit, returns count pushed
+        std::size_t push_batch(const T* values, std::size_t count)
+        {
+            const auto [tail, pushed] = claim(tail_, count, 0);
+            for (std::size_t i = 0; i < pushed; ++i)
+            {
+                auto& slot = slots_[(tail + i) & mask_];
+                wait_for(slot, tail + i);
+                ::new (static_cast<void*>(&slot.storage)) T(values[i]);
+                slot.sequence.store(tail + i + 1, std::memory_order_release);
+            }
+            return pushed;
+        }
+
+        // Pass up to 'max' values to 'consumer' (as r-values), returns count popped
+        template<typename consumer_t>
+        std::size_t pop_batch(consumer_t&& consumer, std::size_t max)
+        {
+            const auto [head, popped] = claim(head_, max, 1);
+            for (std::size_t i = 0; i < popped; ++i)
+            {
+                auto& slot = slots_[(head + i) & mask_];
+                wait_for(slot, head + i + 1);
+                consumer(std::move(slot.value()));
+                slot.value().~T();
+                slot.sequence.store(head + i + mask_ + 1, std::memory_order_release);
+            }
+            return popped;
+        }
+
+        bool empty() const
+        {
+            const auto head = head_.load(std::memory_order_seq_cst);
+            return slots_[head & mask_].sequence.load(std::memory_order_seq_cst) != head + 1;
+        }
+
+        // Approximate when producers/consumers are active
+        std::size_t size() const
+        {
+            const auto head = head_.load(std::memory_order_relaxed);
+            const auto tail = tail_.load(std::memory_order_relaxed);
+            return tail > head ? tail - head : 0;
+        }
+
+        std::size_t capacity() const
+        {
+            return mask_ + 1;
+        }
+
+    private:
+        // Claim up to 'count' slots from 'index', whose sequence is 'position + offset' when ready (0: free, 1: published).
+        // Returns first position and count claimed.
+        std::pair<std::size_t, std::size_t> claim(std::atomic<std::size_t>& index, std::size_t count, std::size_t offset)
+        {
+            count = std::min(count, capacity());
+            auto pos = index.load(std::memory_order_relaxed);
+            while (count)
+            {
+                const auto sequence = slots_[(pos + count - 1) & mask_].sequence.load(std::memory_order_acquire);
+                const auto diff = std::intptr_t(sequence) - std::intptr_t(pos + count - 1 + offset);
+                if (diff == 0)
+                {
+                    if (index.compare_exchange_weak(pos, pos + count, std::memory_order_relaxed))
+                    {
+                        return { pos, count };
+                    }
+                }
+                else if (diff < 0)
+                {
+                    // Not that many slots ready, try fewer
+                    count /= 2;
+                }
+                else
+                {
+                    pos = index.load(std::memory_order_relaxed);
+                }
+            }
+            return { pos, 0 };
+        }
+
+        static void wait_for(const slot_t& slot, std::size_t sequence)
+        {
+            while (slot.sequence.load(std::memory_order_acquire) != sequence)
+            {
+                std::this_thread::yield();
+            }
+        }
+
+        const std::size_t mask_;
+        std::unique_ptr<slot_t[]> slots_;
+        alignas(cache_line_size) std::atomic<std::size_t> tail_{ 0 };
+        alignas(cache_line_size) std::atomic<std::size_t> head_{ 0 };
+    };
+}
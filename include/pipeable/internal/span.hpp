@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+
+#if defined(__has_include)
+#if __has_include(<span>) && ((defined(_MSVC_LANG) && _MSVC_LANG > 201703L) || __cplusplus > 201703L)
+#include <span>
+#define PIPEABLE_HAS_STD_SPAN
+#endif
+#endif
+
+namespace pipeable
+{
+#if defined(PIPEABLE_HAS_STD_SPAN)
+    template<typename T>
+    using span = std::span<T>;
+#else
+    // Minimal stand-in for std::span<T> (dynamic extent) until C++20 is required
+    template<typename T>
+    class span
+    {
+        template<typename container_t>
+        using data_t = decltype(std::data(std::declval<container_t&>()));
+
+        template<typename container_t, typename = void>
+        struct is_compatible_container : std::false_type {};
+        template<typename container_t>
+        struct is_compatible_container<container_t, std::void_t<data_t<container_t>, decltype(std::size(std::declval<container_t&>()))>>
+            : std::is_convertible<std::remove_pointer_t<data_t<container_t>>(*)[], T(*)[]> {};
+
+    public:
+        using element_type = T;
+        using value_type = std::remove_cv_t<T>;
+        using size_type = std::size_t;
+        using pointer = T*;
+        using reference = T&;
+        using iterator = T*;
+
+        constexpr span() noexcept = default;
+        constexpr span(pointer data, size_type size) noexcept :
+            data_(data),
+            size_(size)
+        {}
+        constexpr span(pointer first, pointer last) noexcept :
+            data_(first),
+            size_(static_cast<size_type>(last - first))
+        {}
+        template<typename container_t,
+            typename = std::enable_if_t<!std::is_same_v<std::decay_t<container_t>, span> && is_compatible_container<std::remove_reference_t<container_t>>::value>>
+        constexpr span(container_t&& container) noexcept :
+            data_(std::data(container)),
+            size_(std::size(container))
+        {}
+        template<typename U,
+            typename = std::enable_if_t<std::is_convertible_v<U(*)[], T(*)[]>>>
+        constexpr span(const span<U>& other) noexcept :
+            data_(other.data()),
+            size_(other.size())
+        {}
+
+        constexpr pointer data() const noexcept { return data_; }
+        constexpr size_type size() const noexcept { return size_; }
+        constexpr bool empty() const noexcept { return size_ == 0; }
+        constexpr reference operator[](size_type index) const { return data_[index]; }
+        constexpr reference front() const { return data_[0]; }
+        constexpr reference back() const { return data_[size_ - 1]; }
+        constexpr iterator begin() const noexcept { return data_; }
+        constexpr iterator end() const noexcept { return data_ + size_; }
+
+        constexpr span first(size_type count) const { return { data_, count }; }
+        constexpr span last(size_type count) const { return { data_ + (size_ - count), count }; }
+        constexpr span subspan(size_type offset, size_type count = size_type(-1)) const
+        {
+            return { data_ + offset, count == size_type(-1) ? size_ - offset : count };
+        }
+
+    private:
+        pointer data_ = nullptr;
+        size_type size_ = 0;
+    };
+#endif
+}
@@ -15,4 +15,16 @@ namespace pipeable::type
     }
     template <class T>
     constexpr bool is_iterable_v = details::is_iterable<T>::value;
+
+    namespace details
+    {
+        // Data sources (see data_source.hpp), pulled by 'for_each' through 'pull_each()' rather than iterators
+        template <typename T, typename = void>
+        struct is_data_source : std::false_type {};
+        template <typename T>
+        struct is_data_source<T, std::void_t<decltype(T::template pulls_in_batches<T>)>>
+            : std::true_type {};
+    }
+    template <class T>
+    constexpr bool is_data_source_v = details::is_data_source<std::remove_cv_t<std::remove_reference_t<T>>>::value;
 }
\ No newline at end of file
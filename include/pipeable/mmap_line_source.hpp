@@ -0,0 +1,238 @@
+#pragma once
+
+#include <pipeable/data_source.hpp>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace pipeable
+{
+    namespace impl
+    {
+        // Read-only mapping of a whole file, unmapped on destruction
+        class file_mapping
+        {
+        public:
+#if defined(_WIN32)
+            explicit file_mapping(const std::string& path)
+            {
+                const auto file = ::CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+                if (file == INVALID_HANDLE_VALUE)
+                {
+                    throw std::system_error(static_cast<int>(::GetLastError()), std::system_category(), "mmap_line_source: can't open " + path);
+                }
+                LARGE_INTEGER size;
+                if (!::GetFileSizeEx(file, &size))
+                {
+                    const auto error = ::GetLastError();
+                    ::CloseHandle(file);
+                    throw std::system_error(static_cast<int>(error), std::system_category(), "mmap_line_source: can't stat " + path);
+                }
+                size_ = static_cast<std::size_t>(size.QuadPart);
+                if (size_ > 0)
+                {
+                    const auto mapping = ::CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+                    const auto data = mapping ? ::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+                    const auto error = ::GetLastError();
+                    if (mapping)
+                    {
+                        ::CloseHandle(mapping);
+                    }
+                    if (!data)
+                    {
+                        ::CloseHandle(file);
+                        throw std::system_error(static_cast<int>(error), std::system_category(), "mmap_line_source: can't map " + path);
+                    }
+                    data_ = static_cast<const char*>(data);
+                }
+                // The view stays valid without the mapping & file handles
+                ::CloseHandle(file);
+            }
+#else
+            explicit file_mapping(const std::string& path)
+            {
+                const auto fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+                if (fd < 0)
+                {
+                    throw std::system_error(errno, std::generic_category(), "mmap_line_source: can't open " + path);
+                }
+                struct stat info;
+                if (::fstat(fd, &info) != 0)
+                {
+                    const auto error = errno;
+                    ::close(fd);
+                    throw std::system_error(error, std::generic_category(), "mmap_line_source: can't stat " + path);
+                }
+                size_ = static_cast<std::size_t>(info.st_size);
+                if (size_ > 0)
+                {
+                    auto data = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+                    if (data == MAP_FAILED)
+                    {
+                        const auto error = errno;
+                        ::close(fd);
+                        throw std::system_error(error, std::generic_category(), "mmap_line_source: can't map " + path);
+                    }
+                    // Read-ahead aggressively, drop pages once read (hint only)
+                    ::madvise(data, size_, MADV_SEQUENTIAL);
+                    data_ = static_cast<const char*>(data);
+                }
+                // The mapping stays valid without the descriptor
+                ::close(fd);
+            }
+#endif
+
+            file_mapping(const file_mapping&) = delete;
+            file_mapping& operator=(const file_mapping&) = delete;
+
+            ~file_mapping()
+            {
+                if (data_)
+                {
+#if defined(_WIN32)
+                    ::UnmapViewOfFile(data_);
+#else
+                    ::munmap(const_cast<char*>(data_), size_);
+#endif
+                }
+            }
+
+            const char* data() const
+            {
+                return data_;
+            }
+
+            std::size_t size() const
+            {
+                return size_;
+            }
+
+        private:
+            const char* data_ = nullptr;
+            std::size_t size_ = 0;
+        };
+    }
+
+    /*
+    Data source of the lines ('\n' separated records, without the separator) of a memory mapped file.
+    Lines are string_views pointing into the mapping (never copied), valid as long as this source, or a part split off from it, exists.
+    Splits (see 'try_split' & parallel_for_each) are page-aligned, then moved to the start of the next line, so records are never cut.
+    Maps with mmap on POSIX, MapViewOfFile on Windows.
+    */
+    class mmap_line_source final : public data_source<std::string_view>
+    {
+    public:
+        explicit mmap_line_source(const std::string& path) :
+            mapping_(std::make_shared<const impl::file_mapping>(path)),
+            current_(mapping_->data()),
+            end_(mapping_->data() + mapping_->size())
+        {}
+
+        std::optional<std::string_view> next() override
+        {
+            if (current_ == end_)
+            {
+                return std::nullopt;
+            }
+            return next_line();
+        }
+
+        std::size_t next_batch(span<std::string_view> values) override
+        {
+            std::size_t count = 0;
+            for (; count < values.size() && current_ != end_; ++count)
+            {
+                values[count] = next_line();
+            }
+            return count;
+        }
+
+        bool supports_batch() const noexcept override
+        {
+            return true;
+        }
+
+        // Split off the lines of the upper half of the bytes not pulled yet, unless less than 2 pages are left
+        std::unique_ptr<data_source<std::string_view>> try_split() override
+        {
+            const auto page = page_size();
+            const auto remaining = static_cast<std::size_t>(end_ - current_);
+            if (remaining < 2 * page)
+            {
+                return nullptr;
+            }
+            // Page-aligned split point (relative to the mapping), then just past the line it falls in
+            const auto base = mapping_->data();
+            const auto aligned = (static_cast<std::size_t>(current_ - base) + remaining / 2) / page * page;
+            const auto lineEnd = static_cast<const char*>(std::memchr(base + aligned, '\n', end_ - (base + aligned)));
+            if (!lineEnd || lineEnd + 1 == end_)
+            {
+                return nullptr;
+            }
+            auto upper = std::unique_ptr<mmap_line_source>(new mmap_line_source(mapping_, lineEnd + 1, end_));
+            end_ = lineEnd + 1;
+            return upper;
+        }
+
+        // Bytes left to pull
+        std::size_t remaining() const
+        {
+            return static_cast<std::size_t>(end_ - current_);
+        }
+
+        static std::size_t page_size()
+        {
+#if defined(_WIN32)
+            static const auto size = [] {
+                SYSTEM_INFO info;
+                ::GetSystemInfo(&info);
+                return static_cast<std::size_t>(info.dwPageSize);
+            }();
+#else
+            static const auto size = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+#endif
+            return size;
+        }
+
+    private:
+        mmap_line_source(std::shared_ptr<const impl::file_mapping> mapping, const char* begin, const char* end) :
+            mapping_(std::move(mapping)),
+            current_(begin),
+            end_(end)
+        {}
+
+        // Line starting at 'current_' (not at end), the last one may lack a '\n'
+        std::string_view next_line()
+        {
+            const auto begin = current_;
+            const auto newline = static_cast<const char*>(std::memchr(begin, '\n', end_ - begin));
+            const auto lineEnd = newline ? newline : end_;
+            current_ = newline ? newline + 1 : end_;
+            return std::string_view(begin, static_cast<std::size_t>(lineEnd - begin));
+        }
+
+        std::shared_ptr<const impl::file_mapping> mapping_;
+        const char* current_;
+        const char* end_;
+    };
+}
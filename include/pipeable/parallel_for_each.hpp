@@ -0,0 +1,122 @@
+#pragma once
+
+#include <pipeable/pipeable.hpp>
+#include <pipeable/data_source.hpp>
+#include <pipeable/thread_pool.hpp>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <type_traits>
+
+namespace pipeable
+{
+    namespace impl
+    {
+        // Completion of the partitions consumed by pool workers, keeping the first exception thrown
+        struct partition_jobs
+        {
+            explicit partition_jobs(std::size_t pending) :
+                pending(pending)
+            {}
+
+            void finish(std::exception_ptr partError)
+            {
+                std::scoped_lock lock{ mutex };
+                if (partError && !error)
+                {
+                    error = partError;
+                }
+                if (--pending == 0)
+                {
+                    done.notify_all();
+                }
+            }
+
+            void wait()
+            {
+                std::unique_lock lock{ mutex };
+                done.wait(lock, [this] { return pending == 0; });
+            }
+
+            std::mutex mutex;
+            std::condition_variable done;
+            std::size_t pending;
+            std::exception_ptr error;
+        };
+
+        template<typename T>
+        data_source<T>& as_data_source(data_source<T>& source)
+        {
+            return source;
+        }
+
+        // Split 'source' in up to 'partitions' parts, each pulled into 'downstream' by a pool worker (the first one by this thread)
+        template<typename T, typename downstream_t>
+        void parallel_pull(thread_pool& pool, std::size_t partitions, data_source<T>& source, downstream_t& downstream)
+        {
+            if (pool.is_worker_thread())
+            {
+                // Waiting for parts queued behind this (and possibly every other) busy worker could deadlock
+                data_source<T>::pull_each(source, downstream);
+                return;
+            }
+
+            auto parts = source.split(partitions);
+            partition_jobs jobs{ parts.size() };
+            for (auto& part : parts)
+            {
+                pool.submit([&jobs, &downstream, part = part.get()] {
+                    std::exception_ptr error;
+                    try
+                    {
+                        data_source<T>::pull_each(*part, downstream);
+                    }
+                    catch (...)
+                    {
+                        error = std::current_exception();
+                    }
+                    jobs.finish(error);
+                });
+            }
+
+            std::exception_ptr error;
+            try
+            {
+                data_source<T>::pull_each(source, downstream);
+            }
+            catch (...)
+            {
+                error = std::current_exception();
+            }
+            // Parts (& downstream) must outlive the workers pulling them
+            jobs.wait();
+            if (error || (error = jobs.error))
+            {
+                std::rethrow_exception(error);
+            }
+        }
+    }
+
+    /*
+    Like 'for_each' for a data source, but splitting it (see data_source::try_split) in up to 'partitions' disjoint parts
+    (default: one per pool thread, plus one for the calling thread), each pulled by its own worker: downstream is then invoked
+    concurrently, in no particular order, so it must be thread safe.
+    The calling thread pulls one part itself, and returns once all parts are consumed (rethrowing the first exception thrown, if any).
+    A source which can't be split, or pulled from a worker of the pool itself (eg. nested), is pulled by the calling thread only.
+    Eg. 'source >>= parallel_for_each(pool) >>= stage >>= &threadSafeSink;'
+    */
+    inline auto parallel_for_each(thread_pool& pool, std::size_t partitions = 0)
+    {
+        return assembly::make_interceptor(
+            [&pool, partitions](auto&& downstream, auto&& source)
+        {
+            static_assert(std::is_base_of_v<data_source<typename std::decay_t<decltype(source)>::iterator::value_type>, std::decay_t<decltype(source)>>,
+                "parallel_for_each requires a data_source input.");
+            auto pull = [&](auto&& elem) {
+                downstream(FWD(elem));
+            };
+            impl::parallel_pull(pool, partitions ? partitions : pool.size() + 1, impl::as_data_source(source), pull);
+        });
+    }
+}
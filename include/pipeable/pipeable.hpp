@@ -11,11 +11,22 @@ namespace pipeable
         [](auto&& downstream, auto&& iterable)
     {
         static_assert(pipeable::type::is_iterable_v<decltype(iterable)>, "for_each requires iterable input.");
-        // Iterate with universal reference, and perfectly forward to downstream pipeline
-        for(auto&& elem : iterable)
+        if constexpr (pipeable::type::is_data_source_v<decltype(iterable)>)
         {
-            FWD(downstream)(
-                FWD(elem));
+            // Pull values directly (a block per call from sources filling blocks)
+            std::decay_t<decltype(iterable)>::pull_each(iterable, [&](auto&& elem) {
+                FWD(downstream)(
+                    FWD(elem));
+            });
+        }
+        else
+        {
+            // Iterate with universal reference, and perfectly forward to downstream pipeline
+            for(auto&& elem : iterable)
+            {
+                FWD(downstream)(
+                    FWD(elem));
+            }
         }
     });
 
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <pipeable/channel.hpp>
+#include <pipeable/data_source.hpp>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <optional>
+#include <thread>
+#include <utility>
+
+namespace pipeable
+{
+    /*
+    Data source reading ahead of its consumer: a background thread pulls the wrapped source ('next()')
+    into a bounded buffer of 'depth' values, so producing values (eg. decoding) overlaps consuming them.
+    Pulling blocks (yields) until a value is buffered. An exception thrown by the wrapped source is rethrown
+    to the consumer, once the values pulled before it are consumed.
+    The wrapped source must outlive the adaptor, and not be pulled by anyone else meanwhile.
+    Destroying the adaptor early stops the background thread (after its current 'next()' call).
+    */
+    template<typename T>
+    class prefetching_source final : public data_source<T>
+    {
+    public:
+        static constexpr std::size_t default_depth = 64;
+
+        explicit prefetching_source(data_source<T>& source, std::size_t depth = default_depth) :
+            source_(source),
+            buffer_(depth),
+            thread_([this] { prefetch(); })
+        {}
+
+        prefetching_source(const prefetching_source&) = delete;
+        prefetching_source& operator=(const prefetching_source&) = delete;
+
+        ~prefetching_source()
+        {
+            stopping_.store(true, std::memory_order_relaxed);
+            thread_.join();
+        }
+
+        std::optional<T> next() override
+        {
+            auto value = buffer_.next();
+            if (!value)
+            {
+                rethrow();
+            }
+            return value;
+        }
+
+        std::size_t next_batch(span<T> values) override
+        {
+            const auto count = buffer_.next_batch(values);
+            if (count == 0 && !values.empty())
+            {
+                rethrow();
+            }
+            return count;
+        }
+
+        bool supports_batch() const noexcept override
+        {
+            return true;
+        }
+
+    private:
+        void prefetch()
+        {
+            try
+            {
+                while (!stopping_.load(std::memory_order_relaxed))
+                {
+                    auto value = source_.next();
+                    if (!value)
+                    {
+                        break;
+                    }
+                    // Waits for room, unless stopped meanwhile
+                    while (!buffer_.try_push(std::move(*value)))
+                    {
+                        if (stopping_.load(std::memory_order_relaxed))
+                        {
+                            return;
+                        }
+                        std::this_thread::yield();
+                    }
+                }
+            }
+            catch (...)
+            {
+                // Published by closing the buffer
+                error_ = std::current_exception();
+            }
+            buffer_.close();
+        }
+
+        void rethrow()
+        {
+            if (error_)
+            {
+                std::rethrow_exception(std::exchange(error_, nullptr));
+            }
+        }
+
+        data_source<T>& source_;
+        channel<T> buffer_;
+        std::exception_ptr error_;
+        std::atomic<bool> stopping_{ false };
+        std::thread thread_;
+    };
+}
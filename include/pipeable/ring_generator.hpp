@@ -0,0 +1,280 @@
+#pragma once
+
+#include <pipeable/pipeable.hpp>
+#include <pipeable/internal/delegate.hpp>
+#include <pipeable/internal/mpsc_queue.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <initializer_list>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace pipeable
+{
+    /*
+    Data generator backed by a preallocated ring of values (disruptor style), for high throughput fan-out without copies or allocation.
+    Producers (any number of threads) claim sequence slots, write the value in place and publish it.
+    Each consumer runs on its own thread, reading published slots by const reference (all consumers read the same slot),
+    in batches of whatever is available. A consumer may depend on other consumers, then it only reads slots they have processed.
+    A slot is reused once all consumers have processed it, until then producers wait (yield).
+    An idle consumer yields, then backs off to short sleeps, so it doesn't keep a core busy while nothing is published.
+    An exception thrown by a consumer is counted (see 'consumer::failures()') and dropped, it goes on with the next value.
+    Consumers are added before 'start()'. 'stop()' (also on destruction) returns once all published values are processed,
+    so call it once producers are done.
+    */
+    template<typename T>
+    class ring_generator
+    {
+        static_assert(std::is_default_constructible_v<T>, "Slots are preallocated, so values must be default constructible");
+
+    public:
+        class consumer
+        {
+        public:
+            // Count of values processed
+            std::uint64_t sequence() const
+            {
+                return sequence_.load(std::memory_order_acquire);
+            }
+
+            // Count of values the consumer threw on
+            std::uint64_t failures() const
+            {
+                return failures_.load(std::memory_order_relaxed);
+            }
+
+        private:
+            friend ring_generator;
+
+            template<typename callable_t>
+            consumer(callable_t&& callable, std::vector<const consumer*> dependencies) :
+                callback_([callable = std::forward<callable_t>(callable)](const T& value) mutable { invocation::invoke(callable, value); }),
+                dependencies_(std::move(dependencies))
+            {}
+
+            // Written by the consumer thread only, read by producers & dependent consumers
+            alignas(impl::cache_line_size) std::atomic<std::uint64_t> sequence_{ 0 };
+            std::atomic<std::uint64_t> failures_{ 0 };
+            impl::delegate<void(const T&)> callback_;
+            std::vector<const consumer*> dependencies_;
+            std::thread thread_;
+        };
+
+        static constexpr std::size_t default_capacity = 1024;
+
+        explicit ring_generator(std::size_t capacity = default_capacity) :
+            mask_(impl::round_up_pow2(capacity < 2 ? 2 : capacity) - 1),
+            slots_(new T[mask_ + 1]),
+            published_(new std::atomic<std::uint64_t>[mask_ + 1])
+        {
+            for (std::size_t i = 0; i <= mask_; ++i)
+            {
+                published_[i].store(0, std::memory_order_relaxed);
+            }
+        }
+
+        ring_generator(const ring_generator&) = delete;
+        ring_generator& operator=(const ring_generator&) = delete;
+
+        ~ring_generator()
+        {
+            stop();
+        }
+
+        // Add a consumer reading values after all 'dependencies' did
+        template<typename callable_t,
+            std::enable_if_t<meta::is_invocable_v<callable_t, const T&>, std::nullptr_t> = nullptr>
+        consumer& add_consumer(callable_t&& callable, std::initializer_list<const consumer*> dependencies = {})
+        {
+            if (started_)
+            {
+                throw std::logic_error("Consumers must be added before the ring generator is started");
+            }
+            consumers_.emplace_back(new consumer(std::forward<callable_t>(callable), dependencies));
+            return *consumers_.back();
+        }
+
+        template<typename callable_t,
+            std::enable_if_t<meta::is_invocable_v<callable_t, const T&>, std::nullptr_t> = nullptr>
+        consumer& operator+=(callable_t&& callable)
+        {
+            return add_consumer(std::forward<callable_t>(callable));
+        }
+
+        // Launch a thread per consumer
+        void start()
+        {
+            if (started_)
+            {
+                return;
+            }
+            started_ = true;
+            for (auto& c : consumers_)
+            {
+                c->thread_ = std::thread([this, &self = *c] { run(self); });
+            }
+        }
+
+        // Wait for consumers to process all published values, then join them
+        void stop()
+        {
+            stopping_.store(true, std::memory_order_release);
+            for (auto& c : consumers_)
+            {
+                if (c->thread_.joinable())
+                {
+                    c->thread_.join();
+                }
+            }
+        }
+
+        // Claim a slot, let 'write(T& slot)' fill it in place, then publish it
+        template<typename write_t>
+        void publish(write_t&& write)
+        {
+            const auto sequence = claim(1);
+            std::forward<write_t>(write)(slots_[sequence & mask_]);
+            published_[sequence & mask_].store(sequence + 1, std::memory_order_release);
+        }
+
+        // Claim 'count' consecutive slots (at most capacity at a time), let 'write(T& slot, index)' fill each in place, then publish them
+        template<typename write_t>
+        void publish_batch(std::size_t count, write_t&& write)
+        {
+            for (std::size_t offset = 0; offset < count;)
+            {
+                const auto claimed = std::min(count - offset, capacity());
+                const auto first = claim(claimed);
+                for (std::size_t i = 0; i < claimed; ++i)
+                {
+                    write(slots_[(first + i) & mask_], offset + i);
+                }
+                for (std::size_t i = 0; i < claimed; ++i)
+                {
+                    published_[(first + i) & mask_].store(first + i + 1, std::memory_order_release);
+                }
+                offset += claimed;
+            }
+        }
+
+        // Assign 'arg' to the next slot (also usable as sink of a pipe: 'value >>= ring')
+        template<typename arg_t,
+            std::enable_if_t<std::is_assignable_v<T&, arg_t&&>, std::nullptr_t> = nullptr>
+        void operator()(arg_t&& arg)
+        {
+            publish([&](T& slot) { slot = std::forward<arg_t>(arg); });
+        }
+
+        std::size_t capacity() const
+        {
+            return mask_ + 1;
+        }
+
+    private:
+        static constexpr std::uint64_t unbounded = std::numeric_limits<std::uint64_t>::max();
+        // Idle consumer: yields this many times in a row, then sleeps between polls
+        static constexpr std::uint32_t idle_yields = 1000;
+        static constexpr std::chrono::microseconds idle_sleep{ 100 };
+
+        // Returns first sequence of 'count' slots, once all consumers are done with their previous values
+        std::uint64_t claim(std::size_t count)
+        {
+            const auto first = claimed_.fetch_add(count, std::memory_order_relaxed);
+            const auto last = first + count;
+            if (last > capacity())
+            {
+                const auto required = last - capacity();
+                if (gatingCache_.load(std::memory_order_acquire) < required)
+                {
+                    auto gate = min_sequence(consumers_);
+                    while (gate < required)
+                    {
+                        std::this_thread::yield();
+                        gate = min_sequence(consumers_);
+                    }
+                    gatingCache_.store(gate, std::memory_order_release);
+                }
+            }
+            return first;
+        }
+
+        template<typename consumers_t>
+        static std::uint64_t min_sequence(const consumers_t& consumers)
+        {
+            auto sequence = unbounded;
+            for (const auto& c : consumers)
+            {
+                sequence = std::min(sequence, c->sequence());
+            }
+            return sequence;
+        }
+
+        // End of the contiguous range of published slots starting at 'next'
+        std::uint64_t published_from(std::uint64_t next) const
+        {
+            const auto claimed = claimed_.load(std::memory_order_acquire);
+            while (next < claimed && published_[next & mask_].load(std::memory_order_acquire) == next + 1)
+            {
+                ++next;
+            }
+            return next;
+        }
+
+        void run(consumer& c)
+        {
+            auto next = c.sequence_.load(std::memory_order_relaxed);
+            std::uint32_t idle = 0;
+            while (true)
+            {
+                // Sequence barrier: producers for independent consumers, else the slowest dependency
+                const auto available = c.dependencies_.empty() ? published_from(next) : min_sequence(c.dependencies_);
+                if (available > next)
+                {
+                    for (; next < available; ++next)
+                    {
+                        try
+                        {
+                            c.callback_(slots_[next & mask_]);
+                        }
+                        catch (...)
+                        {
+                            // Not rethrown: producers & dependent consumers would wait for this consumer forever
+                            c.failures_.fetch_add(1, std::memory_order_relaxed);
+                        }
+                    }
+                    c.sequence_.store(next, std::memory_order_release);
+                    idle = 0;
+                }
+                else if (stopping_.load(std::memory_order_acquire) && next == claimed_.load(std::memory_order_acquire))
+                {
+                    return;
+                }
+                else if (idle < idle_yields)
+                {
+                    ++idle;
+                    std::this_thread::yield();
+                }
+                else
+                {
+                    std::this_thread::sleep_for(idle_sleep);
+                }
+            }
+        }
+
+        const std::size_t mask_;
+        std::unique_ptr<T[]> slots_;
+        std::unique_ptr<std::atomic<std::uint64_t>[]> published_;
+        std::vector<std::unique_ptr<consumer>> consumers_;
+        bool started_ = false;
+        alignas(impl::cache_line_size) std::atomic<std::uint64_t> claimed_{ 0 };
+        alignas(impl::cache_line_size) std::atomic<std::uint64_t> gatingCache_{ 0 };
+        std::atomic<bool> stopping_{ false };
+    };
+}
@@ -0,0 +1,280 @@
+#pragma once
+
+#include <pipeable/pipeable.hpp>
+#include <pipeable/internal/span.hpp>
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <typeindex>
+#include <utility>
+#include <vector>
+
+namespace pipeable
+{
+    namespace impl
+    {
+        // Batch of values of any type (checked when a runtime pipe is built)
+        struct erased_batch
+        {
+            const void* data;
+            std::size_t size;
+        };
+
+        class erased_stage
+        {
+        public:
+            virtual ~erased_stage() = default;
+
+            virtual std::type_index input_type() const = 0;
+            virtual std::type_index output_type() const = 0;
+            virtual erased_batch process_erased(erased_batch input) = 0;
+        };
+    }
+
+    /*
+    Stage of a pipe built at runtime (see stage_registry), processing a whole batch of values per (virtual) call.
+    It may output any count of values (eg. filtering), held by the stage itself and valid until its next call.
+    */
+    template<typename in_t, typename out_t>
+    class batch_stage : public impl::erased_stage
+    {
+    public:
+        using input_t = in_t;
+        using output_t = out_t;
+
+        virtual span<const out_t> process(span<const in_t> input) = 0;
+
+        std::type_index input_type() const final
+        {
+            return typeid(in_t);
+        }
+
+        std::type_index output_type() const final
+        {
+            return typeid(out_t);
+        }
+
+        impl::erased_batch process_erased(impl::erased_batch input) final
+        {
+            const auto output = process(span<const in_t>(static_cast<const in_t*>(input.data), input.size));
+            return { output.data(), output.size() };
+        }
+    };
+
+    namespace impl
+    {
+        template<typename callable_t, typename in_t>
+        using map_result_t = std::decay_t<decltype(invocation::invoke(std::declval<callable_t&>(), std::declval<const in_t&>()))>;
+
+        // Applies a callable (or compile time pipe) to each value of the batch, in a loop the callable is inlined into
+        template<typename in_t, typename callable_t>
+        class map_stage final : public batch_stage<in_t, map_result_t<callable_t, in_t>>
+        {
+            using out_t = map_result_t<callable_t, in_t>;
+            static_assert(!std::is_void_v<out_t>, "map_stage: callable must return the value passed on to the next stage.");
+
+        public:
+            explicit map_stage(callable_t callable) :
+                callable_(std::move(callable))
+            {}
+
+            span<const out_t> process(span<const in_t> input) override
+            {
+                if constexpr (std::is_default_constructible_v<out_t> && std::is_move_assignable_v<out_t>)
+                {
+                    // Output buffer is reused from batch to batch
+                    output_.resize(input.size());
+                    for (std::size_t i = 0; i < input.size(); ++i)
+                    {
+                        output_[i] = invocation::invoke(callable_, input[i]);
+                    }
+                }
+                else
+                {
+                    output_.clear();
+                    for (const auto& value : input)
+                    {
+                        output_.push_back(invocation::invoke(callable_, value));
+                    }
+                }
+                return output_;
+            }
+
+        private:
+            callable_t callable_;
+            std::vector<out_t> output_;
+        };
+
+        template<typename T>
+        constexpr bool is_stage_ptr_v = false;
+
+        template<typename T>
+        constexpr bool is_stage_ptr_v<std::unique_ptr<T>> = std::is_base_of_v<erased_stage, T>;
+    }
+
+    // Batch stage applying 'callable' (or a compile time pipe) to each 'in_t' value
+    template<typename in_t, typename callable_t>
+    auto make_batch_stage(callable_t&& callable)
+    {
+        return std::make_unique<impl::map_stage<in_t, std::decay_t<callable_t>>>(FWD(callable));
+    }
+
+    // Stage of a runtime pipe specification: registered name and its arguments
+    struct stage_spec
+    {
+        std::string name;
+        std::vector<std::string> args;
+    };
+
+    /*
+    Pipe of batch stages, built at runtime by a stage_registry: invoked with a batch of 'in_t', it returns a batch of 'out_t'.
+    Each stage costs a single (virtual) call per batch, plus a pass over its output: so a compile time pipe registered
+    as a single stage runs about as fast as when invoked directly (for batches of a few hundred values or more).
+    Returned values are held by the last stage, valid until the next invocation.
+    Eg. 'auto pipe = registry.build<int, std::string>("scale 2 >>= offset 1 >>= format"); values >>= &pipe >>= print_batch;'
+    */
+    template<typename in_t, typename out_t>
+    class runtime_pipe
+    {
+    public:
+        runtime_pipe() = default;
+        runtime_pipe(runtime_pipe&&) noexcept = default;
+        runtime_pipe& operator=(runtime_pipe&&) noexcept = default;
+
+        span<const out_t> operator()(span<const in_t> batch)
+        {
+            impl::erased_batch values{ batch.data(), batch.size() };
+            for (const auto& stage : stages_)
+            {
+                values = stage->process_erased(values);
+            }
+            return span<const out_t>(static_cast<const out_t*>(values.data), values.size);
+        }
+
+        std::size_t stages() const
+        {
+            return stages_.size();
+        }
+
+    private:
+        friend class stage_registry;
+
+        std::vector<std::unique_ptr<impl::erased_stage>> stages_;
+    };
+
+    /*
+    Named factories of batch stages, from which pipes are built at runtime (eg. as specified by configuration).
+    A factory is invoked with the (string) arguments of the stage, and returns either a batch_stage (as unique_ptr),
+    or a callable (or compile time pipe) applied to each value.
+    Stage types are checked when a pipe is built (throwing std::invalid_argument on mismatch, or unknown stage).
+    */
+    class stage_registry
+    {
+    public:
+        using args_t = std::vector<std::string>;
+
+        // Register 'factory(const args_t&)', for stages taking 'in_t' values
+        template<typename in_t, typename factory_t>
+        void add(const std::string& name, factory_t factory)
+        {
+            auto make = [factory = std::move(factory)](const args_t& args) -> std::unique_ptr<impl::erased_stage>
+            {
+                auto stage = factory(args);
+                if constexpr (impl::is_stage_ptr_v<decltype(stage)>)
+                {
+                    static_assert(std::is_same_v<typename decltype(stage)::element_type::input_t, in_t>, "stage_registry: batch stage must take 'in_t' values.");
+                    return stage;
+                }
+                else
+                {
+                    return make_batch_stage<in_t>(std::move(stage));
+                }
+            };
+            if (!factories_.emplace(name, std::move(make)).second)
+            {
+                throw std::invalid_argument("stage_registry: stage '" + name + "' is already registered.");
+            }
+        }
+
+        bool contains(const std::string& name) const
+        {
+            return factories_.count(name) != 0;
+        }
+
+        template<typename in_t, typename out_t>
+        runtime_pipe<in_t, out_t> build(const std::vector<stage_spec>& spec) const
+        {
+            if (spec.empty())
+            {
+                throw std::invalid_argument("stage_registry: a pipe requires 1 or more stages.");
+            }
+            runtime_pipe<in_t, out_t> pipe;
+            std::type_index type = typeid(in_t);
+            for (const auto& stageSpec : spec)
+            {
+                const auto factory = factories_.find(stageSpec.name);
+                if (factory == factories_.end())
+                {
+                    throw std::invalid_argument("stage_registry: unknown stage '" + stageSpec.name + "'.");
+                }
+                auto stage = factory->second(stageSpec.args);
+                if (stage->input_type() != type)
+                {
+                    throw std::invalid_argument("stage_registry: stage '" + stageSpec.name + "' can't take the output of the previous stage.");
+                }
+                type = stage->output_type();
+                pipe.stages_.push_back(std::move(stage));
+            }
+            if (type != typeid(out_t))
+            {
+                throw std::invalid_argument("stage_registry: last stage '" + spec.back().name + "' doesn't output the pipe's output type.");
+            }
+            return pipe;
+        }
+
+        // Build from a specification of stages & their (whitespace separated) arguments, eg. "scale 2 >>= offset 1 >>= format"
+        template<typename in_t, typename out_t>
+        runtime_pipe<in_t, out_t> build(std::string_view spec) const
+        {
+            return build<in_t, out_t>(parse(spec));
+        }
+
+        // Split a specification into stages (each separator must be followed by a stage), eg. "scale 2 >>= format"
+        static std::vector<stage_spec> parse(std::string_view spec)
+        {
+            std::vector<stage_spec> stages;
+            constexpr std::string_view separator = ">>=";
+            for (auto remaining = spec; !remaining.empty() || !stages.empty();)
+            {
+                const auto end = remaining.find(separator);
+                std::istringstream tokens{ std::string(remaining.substr(0, end)) };
+                stage_spec stage;
+                tokens >> stage.name;
+                for (std::string arg; tokens >> arg;)
+                {
+                    stage.args.push_back(std::move(arg));
+                }
+                if (stage.name.empty())
+                {
+                    throw std::invalid_argument("stage_registry: empty stage in '" + std::string(spec) + "'.");
+                }
+                stages.push_back(std::move(stage));
+                if (end == std::string_view::npos)
+                {
+                    break;
+                }
+                remaining = remaining.substr(end + separator.size());
+            }
+            return stages;
+        }
+
+    private:
+        std::map<std::string, std::function<std::unique_ptr<impl::erased_stage>(const args_t&)>, std::less<>> factories_;
+    };
+}
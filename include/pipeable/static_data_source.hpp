@@ -0,0 +1,55 @@
+#pragma once
+
+#include <pipeable/data_source.hpp>
+
+namespace pipeable
+{
+    /*
+    Data source without virtual dispatch (CRTP): 'derived_t' implements 'std::optional<T> next()',
+    called directly by the iterator and 'for_each', so consumption loops can be inlined.
+    Like data_source, define 'next_batch(span<T>)' in 'derived_t' to have 'for_each' pull blocks of 'batch_size' values.
+    Eg. 'struct int_source : static_data_source<int_source, int> { std::optional<int> next(); };'
+    */
+    template<typename derived_t, typename T>
+    struct static_data_source
+    {
+        static constexpr std::size_t batch_size = 256;
+
+        // Pull up to 'values.size()' values into 'values', returns count pulled (0 once there are no more values).
+        // Default pulls values one by one through 'next()', hidden by a 'next_batch' of 'derived_t'.
+        std::size_t next_batch(span<T> values)
+        {
+            return impl::pull_one_by_one(derived(), values);
+        }
+
+        // Whether 'for_each' pulls blocks from 'source_t': only if it defines its own next_batch
+        template<typename source_t>
+        static constexpr bool pulls_in_batches = impl::is_batchable_v<T>
+            && !std::is_same_v<decltype(&source_t::next_batch), std::size_t (static_data_source::*)(span<T>)>;
+
+        // Pass each value of 'source' to 'callback', as 'for_each' does
+        template<typename source_t, typename callback_t>
+        static void pull_each(source_t& source, callback_t&& callback)
+        {
+            impl::pull_each<pulls_in_batches<source_t>, T, batch_size>(source, callback);
+        }
+
+        using iterator = impl::source_iterator<derived_t, T>;
+        using sentinel = impl::source_sentinel;
+
+        iterator begin()
+        {
+            return iterator(derived());
+        }
+        sentinel end()
+        {
+            return {};
+        }
+
+    private:
+        derived_t& derived()
+        {
+            return static_cast<derived_t&>(*this);
+        }
+    };
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <pipeable/pipeable.hpp>
+
+namespace pipeable
+{
+    /*
+    A data generator with a fixed set of receivers known at compile time.
+    Receivers are stored by value (or pointer) without type erasure, and every emission is a fold over all
+    receivers which the compiler can inline into straight-line calls.
+    All receivers but the last receive the argument as an l-value, the last one gets it forwarded (it may be moved from).
+    Eg. 'static_generator gen(&receiver1, receiver2); 1 >>= gen;'
+    */
+    template<typename... receivers_t>
+    struct static_generator : impl::custom_pipeable_tag
+    {
+        static_assert(sizeof...(receivers_t) > 0, "static_generator: 1 or more receivers required.");
+
+        template<typename... Ts,
+            typename = std::enable_if_t<sizeof...(Ts) == sizeof...(receivers_t) && !(std::is_same_v<std::decay_t<Ts>, static_generator> || ...)>>
+        constexpr static_generator(Ts&&... receivers) :
+            receivers_(std::in_place, FWD(receivers)...)
+        {
+        }
+        static_generator() = default;
+
+        // All receivers but the last must be invocable with an l-value, the last with arg as-is
+        template<typename arg_t, std::size_t... indexes>
+        static constexpr bool is_invocable_with(std::index_sequence<indexes...>)
+        {
+            constexpr auto last = sizeof...(indexes) - 1;
+            return (meta::is_invocable_v<receivers_t, std::conditional_t<indexes == last, arg_t, std::remove_reference_t<arg_t>&>> && ...);
+        }
+
+        template<typename arg_t,
+            typename = std::enable_if_t<is_invocable_with<arg_t>(std::index_sequence_for<receivers_t...>())>>
+        constexpr void operator()(arg_t&& arg)
+        {
+            emit<arg_t>(receivers_, arg, std::index_sequence_for<receivers_t...>());
+        }
+
+        template<typename arg_t,
+            typename = std::enable_if_t<is_invocable_with<arg_t>(std::index_sequence_for<receivers_t...>())>>
+        constexpr void operator()(arg_t&& arg) const
+        {
+            emit<arg_t>(receivers_, arg, std::index_sequence_for<receivers_t...>());
+        }
+
+    private:
+        template<typename arg_t, typename storage_t, std::size_t... indexes>
+        static constexpr void emit(storage_t& receivers, std::remove_reference_t<arg_t>& arg, std::index_sequence<indexes...>)
+        {
+            constexpr auto last = sizeof...(indexes) - 1;
+            (invocation::invoke(impl::get<indexes>(receivers), forward_if<indexes == last, arg_t>(arg)), ...);
+        }
+
+        template<bool forward, typename arg_t>
+        static constexpr decltype(auto) forward_if(std::remove_reference_t<arg_t>& arg)
+        {
+            if constexpr (forward)
+            {
+                return std::forward<arg_t>(arg);
+            }
+            else
+            {
+                return (arg);
+            }
+        }
+
+        impl::callable_storage_t<receivers_t...> receivers_;
+    };
+
+    // Deduction guide to figure out receiver types
+    template<typename T, typename... Ts>
+    static_generator(T&&, Ts&&...)
+        ->
+        static_generator<std::remove_reference_t<T>, std::remove_reference_t<Ts>...>;
+}
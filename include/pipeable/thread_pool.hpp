@@ -0,0 +1,120 @@
+#pragma once
+
+#include <pipeable/internal/delegate.hpp>
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace pipeable
+{
+    /*
+    Fixed set of worker threads executing submitted tasks (FIFO).
+    Tasks are stored in an inline delegate, so small tasks (eg. capturing a pointer or two) are submitted without allocation.
+    On destruction, all submitted tasks (including those submitted by running tasks) are completed before workers are joined.
+    Tasks must not throw: as for std::thread, an exception escaping a task terminates.
+    */
+    class thread_pool
+    {
+    public:
+        using task_t = impl::delegate<void()>;
+
+        explicit thread_pool(std::size_t threadCount = std::max(1u, std::thread::hardware_concurrency()))
+        {
+            workers_.reserve(threadCount);
+            for (std::size_t i = 0; i < threadCount; ++i)
+            {
+                workers_.emplace_back([this] { work(); });
+            }
+        }
+
+        thread_pool(const thread_pool&) = delete;
+        thread_pool& operator=(const thread_pool&) = delete;
+
+        ~thread_pool()
+        {
+            {
+                std::scoped_lock lock{ mutex_ };
+                stopping_ = true;
+            }
+            workAvailable_.notify_all();
+            for (auto& worker : workers_)
+            {
+                worker.join();
+            }
+        }
+
+        template<typename task_callable_t>
+        void submit(task_callable_t&& task)
+        {
+            {
+                std::scoped_lock lock{ mutex_ };
+                tasks_.emplace_back(std::forward<task_callable_t>(task));
+                ++unfinished_;
+            }
+            workAvailable_.notify_one();
+        }
+
+        // Block until all submitted tasks (including those submitted meanwhile) have completed
+        void wait_idle()
+        {
+            std::unique_lock lock{ mutex_ };
+            idle_.wait(lock, [this] { return unfinished_ == 0; });
+        }
+
+        std::size_t size() const
+        {
+            return workers_.size();
+        }
+
+        // Whether the calling thread is a worker of this pool (which mustn't block waiting on tasks it submits to the pool)
+        bool is_worker_thread() const
+        {
+            return current_pool() == this;
+        }
+
+    private:
+        static const thread_pool*& current_pool()
+        {
+            static thread_local const thread_pool* pool = nullptr;
+            return pool;
+        }
+
+        void work()
+        {
+            current_pool() = this;
+            std::unique_lock lock{ mutex_ };
+            while (true)
+            {
+                workAvailable_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+                if (tasks_.empty())
+                {
+                    // Stopping, and nothing left to do
+                    return;
+                }
+
+                auto task = std::move(tasks_.front());
+                tasks_.pop_front();
+                lock.unlock();
+                task();
+                lock.lock();
+                if (--unfinished_ == 0)
+                {
+                    idle_.notify_all();
+                }
+            }
+        }
+
+        std::mutex mutex_;
+        std::condition_variable workAvailable_;
+        std::condition_variable idle_;
+        std::deque<task_t> tasks_;
+        std::size_t unfinished_ = 0;
+        bool stopping_ = false;
+        std::vector<std::thread> workers_;
+    };
+}
@@ -0,0 +1,179 @@
+#include <pipeable/pipeable.hpp>
+#include <pipeable/any_pipe.hpp>
+
+#include <catch2/catch.hpp>
+#include <array>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+using namespace pipeable;
+
+namespace
+{
+    // Counts its moves, with a configurable size (to be stored inline or not)
+    template<std::size_t size>
+    struct move_counting_twice
+    {
+        explicit move_counting_twice(int& moves) :
+            moves(&moves)
+        {}
+        move_counting_twice(move_counting_twice&& rhs) noexcept :
+            moves(rhs.moves)
+        {
+            ++*moves;
+        }
+
+        int operator()(int val) const
+        {
+            return val * 2;
+        }
+
+        int* moves;
+        std::array<char, size> padding{};
+    };
+}
+
+SCENARIO("Erase a pipe")
+{
+    GIVEN("a pipe erased as any_pipe")
+    {
+        any_pipe<std::string(int)> pipeline = assembly::compose([](int val) { return val + 1; }, [](int val) { return std::to_string(val); });
+        THEN("it is invoked as the pipe, in a single erased call")
+        {
+            REQUIRE(pipeline);
+            REQUIRE(pipeline.segments() == 1);
+            REQUIRE(pipeline(1) == "2");
+            REQUIRE((2 >>= pipeline) == "3");
+        }
+        WHEN("moved")
+        {
+            auto moved = std::move(pipeline);
+            THEN("the pipe is moved along")
+            {
+                REQUIRE(moved(3) == "4");
+            }
+        }
+    }
+    GIVEN("an empty any_pipe")
+    {
+        any_pipe<void(int)> pipeline;
+        THEN("it converts to false")
+        {
+            REQUIRE_FALSE(pipeline);
+            REQUIRE(pipeline.segments() == 0);
+        }
+    }
+    GIVEN("a move-only pipe")
+    {
+        auto offset = std::make_unique<int>(10);
+        any_pipe<int(int)> pipeline = [offset = std::move(offset)](int val) { return val + *offset; };
+        THEN("it is erased")
+        {
+            REQUIRE(pipeline(1) == 11);
+        }
+    }
+    GIVEN("small & large callables")
+    {
+        int smallMoves = 0, largeMoves = 0;
+        any_pipe<int(int)> small = move_counting_twice<8>{ smallMoves };
+        any_pipe<int(int)> large = move_counting_twice<256>{ largeMoves };
+        smallMoves = largeMoves = 0;
+        WHEN("moved")
+        {
+            auto movedSmall = std::move(small);
+            auto movedLarge = std::move(large);
+            THEN("small callables are stored inline (moved along), large ones allocated (never moved)")
+            {
+                REQUIRE(smallMoves == 1);
+                REQUIRE(largeMoves == 0);
+                REQUIRE(movedSmall(1) == 2);
+                REQUIRE(movedLarge(2) == 4);
+            }
+        }
+    }
+    GIVEN("pipes returning void & references")
+    {
+        std::vector<int> vals;
+        any_pipe<void(int)> sink = [&](int val) { vals.push_back(val); };
+        any_pipe<std::vector<int>&(int)> lookup = [&](int) -> std::vector<int>& { return vals; };
+        THEN("they are invoked")
+        {
+            sink(1);
+            REQUIRE(vals == std::vector<int>{ 1 });
+            REQUIRE(&lookup(0) == &vals);
+        }
+    }
+    GIVEN("callables & pipes whose result can't be returned as the signature's")
+    {
+        const auto toInt = [](int val) { return val; };
+        const auto pipe = assembly::compose([](int val) { return val + 1; }, [](int val) { return val; });
+        const auto sum = assembly::compose([](int lhs, int rhs) { return lhs + rhs; }, [](int val) { return val; });
+        THEN("they can't be erased")
+        {
+            static_assert(!std::is_constructible_v<any_pipe<std::string(int)>, decltype(toInt)>);
+            static_assert(!std::is_constructible_v<any_pipe<std::string(int)>, decltype(pipe)>);
+            static_assert(!std::is_constructible_v<any_pipe<std::string(int, int)>, decltype(sum)>);
+            static_assert(std::is_constructible_v<any_pipe<long(int, int)>, decltype(sum)>);
+            // A reference can't be returned to a temporary
+            static_assert(!std::is_constructible_v<any_pipe<const int&(int)>, decltype(toInt)>);
+            static_assert(!std::is_constructible_v<any_pipe<const int&(int)>, decltype(pipe)>);
+        }
+    }
+}
+
+SCENARIO("Compose erased pipes")
+{
+    GIVEN("three any_pipes")
+    {
+        any_pipe<int(const std::string&)> parse = [](const std::string& str) { return std::stoi(str); };
+        any_pipe<int(int)> twice = [](int val) { return val * 2; };
+        any_pipe<std::string(int)> format = assembly::compose([](int val) { return val + 1; }, [](int val) { return std::to_string(val); });
+
+        WHEN("composed as: parse >>= twice >>= format")
+        {
+            any_pipe<std::string(const std::string&)> pipeline = std::move(parse) >>= std::move(twice) >>= std::move(format);
+            THEN("they are merged into one any_pipe, invoking each erased part in turn")
+            {
+                REQUIRE(pipeline.segments() == 3);
+                REQUIRE(pipeline("20") == "41");
+                REQUIRE_FALSE(parse);
+                REQUIRE_FALSE(format);
+            }
+            AND_WHEN("composed again, and moved")
+            {
+                any_pipe<std::size_t(std::string)> length = [](std::string str) { return str.size(); };
+                auto longer = std::move(pipeline) >>= std::move(length);
+                auto moved = std::move(longer);
+                THEN("the merged any_pipe is flat")
+                {
+                    REQUIRE(moved.segments() == 4);
+                    REQUIRE(moved("500") == 4);
+                }
+            }
+        }
+        WHEN("composed with a pipe returning void")
+        {
+            int received = 0;
+            any_pipe<void(int)> sink = [&](int val) { received = val; };
+            auto pipeline = std::move(twice) >>= std::move(sink);
+            THEN("the result is void")
+            {
+                REQUIRE(std::is_same_v<decltype(pipeline), any_pipe<void(int)>>);
+                pipeline(5);
+                REQUIRE(received == 10);
+            }
+        }
+        WHEN("a composed part throws")
+        {
+            any_pipe<int(int)> fail = [](int) -> int { throw std::runtime_error("stage failed"); };
+            auto pipeline = std::move(twice) >>= std::move(fail) >>= std::move(format);
+            THEN("the exception propagates")
+            {
+                REQUIRE_THROWS_AS(pipeline(1), std::runtime_error);
+            }
+        }
+    }
+}
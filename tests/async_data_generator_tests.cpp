@@ -0,0 +1,210 @@
+#include <pipeable/async_data_generator.hpp>
+
+#include <catch2/catch.hpp>
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace pipeable;
+
+namespace
+{
+    struct recording_receiver
+    {
+        void operator()(int val)
+        {
+            receivedInts.push_back(val);
+            received.push_back(std::to_string(val));
+        }
+        void operator()(const std::string& val)
+        {
+            received.push_back(val);
+        }
+        std::vector<int> receivedInts;
+        std::vector<std::string> received;
+    };
+}
+
+SCENARIO("Asynchronous data generator")
+{
+    GIVEN("an async data generator")
+    {
+        thread_pool pool{ 4 };
+        async_data_generator<int> generator{ pool };
+
+        WHEN("multiple receivers are registered and values emitted")
+        {
+            std::vector<recording_receiver> receivers(4);
+            std::vector<async_subscription<int>> subscriptions;
+            for (auto& receiver : receivers)
+            {
+                subscriptions.push_back(generator += &receiver);
+            }
+            const auto count = 1000;
+            for (auto i = 0; i < count; ++i)
+            {
+                generator(i);
+            }
+            generator.wait_idle();
+
+            THEN("each receiver gets all values in emission order")
+            {
+                for (auto& receiver : receivers)
+                {
+                    REQUIRE(receiver.receivedInts.size() == count);
+                    for (auto i = 0; i < count; ++i)
+                    {
+                        REQUIRE(receiver.receivedInts[i] == i);
+                    }
+                }
+            }
+            THEN("metrics report all values delivered and the queue empty")
+            {
+                for (auto& sub : subscriptions)
+                {
+                    const auto metrics = sub.metrics();
+                    REQUIRE(metrics.delivered == count);
+                    REQUIRE(metrics.queue_depth == 0);
+                    REQUIRE(metrics.max_queue_depth <= count);
+                }
+            }
+            AND_WHEN("a receiver is deregistered by pointer")
+            {
+                generator -= &receivers[0];
+                generator(count);
+                generator.wait_idle();
+                THEN("it no longer receives values")
+                {
+                    REQUIRE(receivers[0].receivedInts.size() == count);
+                    REQUIRE(receivers[1].receivedInts.size() == count + 1);
+                }
+            }
+        }
+        WHEN("a receiver is slow")
+        {
+            std::atomic_bool release = false;
+            std::atomic_int slowReceived = 0;
+            std::atomic_int fastReceived = 0;
+            generator += [&](int) {
+                while (!release) { std::this_thread::yield(); }
+                ++slowReceived;
+            };
+            generator += [&](int) { ++fastReceived; };
+
+            THEN("emitting and other receivers don't wait for it")
+            {
+                generator(1);
+                generator(2);
+                while (fastReceived < 2) { std::this_thread::yield(); }
+                REQUIRE(slowReceived == 0);
+
+                release = true;
+                generator.wait_idle();
+                REQUIRE(slowReceived == 2);
+            }
+        }
+        WHEN("a receiver throws on some values")
+        {
+            std::vector<int> received;
+            auto sub = generator += [&](int val) {
+                if (val % 2 == 0)
+                {
+                    throw std::runtime_error("even");
+                }
+                received.push_back(val);
+            };
+            for (auto i = 0; i < 10; ++i)
+            {
+                generator(i);
+            }
+            generator.wait_idle();
+
+            THEN("it still gets all later values, and failures are counted")
+            {
+                REQUIRE(received == std::vector<int>{ 1, 3, 5, 7, 9 });
+                REQUIRE(sub.metrics().delivered == 10);
+                REQUIRE(sub.metrics().failed == 5);
+            }
+        }
+    }
+    GIVEN("an async data generator on a pool shared with other work")
+    {
+        thread_pool pool{ 2 };
+        std::atomic_bool release = false;
+        pool.submit([&] {
+            while (!release) { std::this_thread::yield(); }
+        });
+
+        WHEN("values are emitted and the generator waited on")
+        {
+            std::atomic_int received = 0;
+            {
+                async_data_generator<int> generator{ pool };
+                generator += [&](int) { ++received; };
+                generator(1);
+                generator(2);
+                generator.wait_idle();
+                REQUIRE(received == 2);
+                generator(3);
+            }
+            THEN("it doesn't wait on other work of the pool, neither when destroyed")
+            {
+                REQUIRE(received == 3);
+                REQUIRE_FALSE(release);
+            }
+        }
+        release = true;
+        pool.wait_idle();
+    }
+    GIVEN("an async data generator outputting r-value strings")
+    {
+        thread_pool pool{ 2 };
+        async_data_generator<std::string&&> generator{ pool };
+
+        WHEN("multiple receivers are registered and a value emitted")
+        {
+            std::vector<std::string> received(3);
+            for (auto& value : received)
+            {
+                generator += [&value](std::string&& str) { value = std::move(str); };
+            }
+            generator(std::string("a string too long for small string optimization"));
+            generator.wait_idle();
+            THEN("each receiver gets the whole value")
+            {
+                for (const auto& value : received)
+                {
+                    REQUIRE(value == "a string too long for small string optimization");
+                }
+            }
+        }
+    }
+    GIVEN("an async data generator outputting int & string, with a small queue")
+    {
+        thread_pool pool{ 2 };
+        async_data_generator<int, std::string> generator{ pool, 4 };
+
+        WHEN("a receiver callable with both is registered and more values than fit the queue are emitted")
+        {
+            recording_receiver receiver;
+            generator += &receiver;
+            for (auto i = 0; i < 100; ++i)
+            {
+                generator(i);
+                generator(std::string("s") + std::to_string(i));
+            }
+            generator.wait_idle();
+            THEN("it receives all values of both types in emission order")
+            {
+                REQUIRE(receiver.received.size() == 200);
+                for (auto i = 0; i < 100; ++i)
+                {
+                    REQUIRE(receiver.received[2 * i] == std::to_string(i));
+                    REQUIRE(receiver.received[2 * i + 1] == "s" + std::to_string(i));
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,205 @@
+#include <pipeable/async_data_generator.hpp>
+#include <pipeable/backpressure.hpp>
+#include <pipeable/channel.hpp>
+
+#include <catch2/catch.hpp>
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace pipeable;
+
+namespace
+{
+    struct tick
+    {
+        int symbol;
+        int price;
+    };
+
+    template<typename channel_t>
+    std::vector<int> drain(channel_t& chan)
+    {
+        chan.close();
+        std::vector<int> vals;
+        while (auto val = chan.next())
+        {
+            vals.push_back(*val);
+        }
+        return vals;
+    }
+}
+
+SCENARIO("Backpressure policies of a full channel")
+{
+    GIVEN("a full channel dropping the newest value")
+    {
+        channel<int, channel_mode::spsc, backpressure::drop_newest> chan{ 4 };
+        chan.push_batch(std::vector{ 1, 2, 3, 4, 5 });
+        WHEN("more values are pushed")
+        {
+            6 >>= chan;
+            THEN("they are discarded, and counted")
+            {
+                REQUIRE(chan.metrics().dropped == 2);
+                REQUIRE(drain(chan) == std::vector{ 1, 2, 3, 4 });
+            }
+        }
+    }
+    GIVEN("a full channel dropping the oldest value")
+    {
+        channel<int, channel_mode::spsc, backpressure::drop_oldest> chan{ 4 };
+        chan.push_batch(std::vector{ 1, 2, 3, 4, 5 });
+        WHEN("more values are pushed")
+        {
+            6 >>= chan;
+            THEN("the oldest queued values are discarded, and counted")
+            {
+                REQUIRE(chan.metrics().dropped == 2);
+                REQUIRE(drain(chan) == std::vector{ 3, 4, 5, 6 });
+            }
+        }
+    }
+    GIVEN("a channel coalescing values by key")
+    {
+        mpmc_channel<tick, backpressure::coalesce<int(*)(const tick&)>> chan{ 2, { [](const tick& t) { return t.symbol; } } };
+        WHEN("values with the same key are pushed before being consumed")
+        {
+            chan(tick{ 1, 10 });
+            chan(tick{ 2, 20 });
+            chan(tick{ 1, 11 });
+            chan(tick{ 1, 12 });
+            THEN("only the latest value per key is consumed, in order of first push")
+            {
+                REQUIRE(chan.metrics().coalesced == 2);
+                REQUIRE_FALSE(chan.try_push(tick{ 3, 30 }));
+                auto first = chan.next();
+                auto second = chan.next();
+                REQUIRE(first->symbol == 1);
+                REQUIRE(first->price == 12);
+                REQUIRE(second->symbol == 2);
+                REQUIRE(second->price == 20);
+            }
+        }
+    }
+    GIVEN("a channel spilling to disk")
+    {
+        channel<int, channel_mode::spsc, backpressure::spill> chan{ 4 };
+        WHEN("more values than fit are pushed")
+        {
+            std::vector<int> vals(100);
+            for (auto i = 0; i < 100; ++i)
+            {
+                vals[i] = i;
+            }
+            chan.push_batch(span<const int>(vals).first(50));
+            for (auto i = 50; i < 100; ++i)
+            {
+                i >>= chan;
+            }
+            THEN("all values are consumed in order, and those overflowing counted as spilled")
+            {
+                REQUIRE(chan.metrics().spilled == 96);
+                REQUIRE(chan.size() == 100);
+                REQUIRE(drain(chan) == vals);
+            }
+        }
+        WHEN("a producer outpaces a consumer on another thread")
+        {
+            const auto count = 20'000;
+            std::thread producer([&] {
+                for (auto i = 0; i < count; ++i)
+                {
+                    i >>= chan;
+                }
+                chan.close();
+            });
+            std::vector<int> received;
+            chan >>= for_each >>= [&](int val) { received.push_back(val); };
+            producer.join();
+            THEN("values are received in order")
+            {
+                REQUIRE(received.size() == count);
+                for (auto i = 0; i < count; ++i)
+                {
+                    REQUIRE(received[i] == i);
+                }
+            }
+        }
+    }
+    GIVEN("a channel spilling to a file that can't be created")
+    {
+        channel<int, channel_mode::spsc, backpressure::spill> chan{ 2, backpressure::spill{ "nonexistent-directory/spill" } };
+        THEN("the file is only opened once a value overflows")
+        {
+            1 >>= chan;
+            2 >>= chan;
+            REQUIRE_THROWS_AS(3 >>= chan, std::runtime_error);
+            REQUIRE(drain(chan) == std::vector<int>{ 1, 2 });
+        }
+    }
+}
+
+SCENARIO("Backpressure policies of an async data generator")
+{
+    GIVEN("an async data generator dropping the newest value, with a blocked receiver")
+    {
+        thread_pool pool{ 1 };
+        basic_async_data_generator<backpressure::drop_newest, int> generator{ pool, 4 };
+        std::atomic_bool release = false;
+        std::vector<int> received;
+        auto sub = generator += [&](int val) {
+            while (!release) { std::this_thread::yield(); }
+            received.push_back(val);
+        };
+
+        WHEN("more values are emitted than fit in its queue")
+        {
+            for (auto i = 0; i < 100; ++i)
+            {
+                generator(i);
+            }
+            release = true;
+            generator.wait_idle();
+            THEN("emission never blocks, and values not delivered are counted as dropped")
+            {
+                REQUIRE(received.size() < 100);
+                REQUIRE(sub.metrics().backpressure.dropped == 100 - received.size());
+                REQUIRE(sub.metrics().delivered == received.size());
+            }
+        }
+    }
+    GIVEN("an async data generator coalescing values by key, with a blocked receiver")
+    {
+        thread_pool pool{ 1 };
+        auto key = [](const std::string& val) { return val.substr(0, 1); };
+        basic_async_data_generator<backpressure::coalesce<decltype(key)>, std::string> generator{ pool, 16, { key } };
+        std::atomic_bool release = false;
+        std::vector<std::string> received;
+        auto sub = generator += [&](const std::string& val) {
+            while (!release) { std::this_thread::yield(); }
+            received.push_back(val);
+        };
+
+        WHEN("values are emitted for a few keys")
+        {
+            generator(std::string("a0"));
+            // Wait until the first value is being delivered, so the rest is queued
+            while (sub.metrics().queue_depth != 0) { std::this_thread::yield(); }
+            for (auto i = 1; i < 10; ++i)
+            {
+                generator("a" + std::to_string(i));
+                generator("b" + std::to_string(i));
+            }
+            release = true;
+            generator.wait_idle();
+            THEN("only the latest queued value per key is delivered")
+            {
+                REQUIRE(received == std::vector<std::string>{ "a0", "a9", "b9" });
+                REQUIRE(sub.metrics().backpressure.coalesced == 16);
+            }
+        }
+    }
+}
@@ -0,0 +1,181 @@
+#include <pipeable/pipeable.hpp>
+#include <pipeable/channel.hpp>
+
+#include <catch2/catch.hpp>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+using namespace pipeable;
+
+SCENARIO("Single producer, single consumer channel")
+{
+    GIVEN("a channel")
+    {
+        channel<int> chan{ 4 };
+
+        THEN("it is a data source, and capacity is rounded up to a power of two")
+        {
+            REQUIRE(std::is_base_of_v<data_source<int>, channel<int>>);
+            REQUIRE(channel<int>{ 5 }.capacity() == 8);
+        }
+
+        WHEN("values are piped into it, and it's closed")
+        {
+            1 >>= chan;
+            2 >>= [](int val) { return val * 10; } >>= &chan;
+            chan.close();
+
+            THEN("values are pulled in order, then no value")
+            {
+                REQUIRE(chan.next() == 1);
+                REQUIRE(chan.next() == 20);
+                REQUIRE_FALSE(chan.next().has_value());
+            }
+        }
+        WHEN("it's full")
+        {
+            std::vector<int> vals = { 1, 2, 3, 4, 5, 6 };
+            const auto pushed = chan.try_push_batch(vals);
+            THEN("only as many values as fit are pushed")
+            {
+                REQUIRE(pushed == 4);
+                REQUIRE_FALSE(chan.try_push(7));
+                std::vector<int> popped(8);
+                REQUIRE(chan.pop_batch(popped) == 4);
+                REQUIRE(popped[3] == 4);
+                REQUIRE(chan.try_push(7));
+            }
+        }
+    }
+    GIVEN("a producer thread piping into a channel, consumed as a data source on another thread")
+    {
+        channel<int> chan{ 64 };
+        const auto count = 100'000;
+        std::thread producer([&] {
+            std::vector<int> batch(10);
+            for (auto i = 0; i < count; i += 10)
+            {
+                std::iota(batch.begin(), batch.end(), i);
+                if (i % 20)
+                {
+                    chan.push_batch(batch);
+                }
+                else
+                {
+                    for (auto val : batch)
+                    {
+                        val >>= chan;
+                    }
+                }
+            }
+            chan.close();
+        });
+
+        std::vector<int> received;
+        chan >>= for_each >>= [&](int val) { received.push_back(val); };
+        producer.join();
+
+        THEN("all values are received in order")
+        {
+            REQUIRE(received.size() == count);
+            for (auto i = 0; i < count; ++i)
+            {
+                REQUIRE(received[i] == i);
+            }
+        }
+    }
+    GIVEN("a channel of move-only values")
+    {
+        channel<std::unique_ptr<int>> chan;
+        std::make_unique<int>(1) >>= chan;
+        chan.close();
+        THEN("values are moved through")
+        {
+            auto val = chan.next();
+            REQUIRE(val.has_value());
+            REQUIRE(**val == 1);
+        }
+    }
+}
+
+SCENARIO("Multi producer, multi consumer channel")
+{
+    GIVEN("producer and consumer threads sharing a channel")
+    {
+        mpmc_channel<int> chan{ 64 };
+        const auto producerCount = 4;
+        const auto consumerCount = 3;
+        const auto perProducer = 20'000;
+
+        std::atomic_int producersDone = 0;
+        std::vector<std::thread> producers;
+        for (auto p = 0; p < producerCount; ++p)
+        {
+            producers.emplace_back([&, p] {
+                std::vector<int> batch(8, 1);
+                for (auto i = 0; i < perProducer; i += 8)
+                {
+                    if (p % 2)
+                    {
+                        chan.push_batch(batch);
+                    }
+                    else
+                    {
+                        for (auto val : batch)
+                        {
+                            val >>= chan;
+                        }
+                    }
+                }
+                if (++producersDone == producerCount)
+                {
+                    chan.close();
+                }
+            });
+        }
+
+        std::atomic<std::int64_t> sum = 0;
+        std::atomic<std::int64_t> count = 0;
+        std::vector<std::thread> consumers;
+        for (auto c = 0; c < consumerCount; ++c)
+        {
+            consumers.emplace_back([&, c] {
+                if (c % 2)
+                {
+                    std::vector<int> vals(16);
+                    while (auto pulled = chan.pop_batch(vals))
+                    {
+                        count += pulled;
+                        sum += std::accumulate(vals.begin(), vals.begin() + pulled, 0);
+                    }
+                }
+                else
+                {
+                    while (auto val = chan.next())
+                    {
+                        ++count;
+                        sum += *val;
+                    }
+                }
+            });
+        }
+        for (auto& thread : producers)
+        {
+            thread.join();
+        }
+        for (auto& thread : consumers)
+        {
+            thread.join();
+        }
+
+        THEN("each value is consumed exactly once")
+        {
+            REQUIRE(count == producerCount * perProducer);
+            REQUIRE(sum == producerCount * perProducer);
+        }
+    }
+}
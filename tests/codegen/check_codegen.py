@@ -0,0 +1,94 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+Compiles codegen_cases.cpp, disassembles the object file and compares every 'pipe_<case>'
+function against its hand-written 'hand_<case>' counterpart.
+
+Fails if a pipeline emits more call instructions than its hand-written equivalent, or if its
+instruction count exceeds the hand-written one by more than the allowed threshold.
+"""
+
+import argparse
+import os
+import re
+import subprocess
+import sys
+import tempfile
+
+CALL_MNEMONICS = ("call", "callq", "bl", "blr", "blx")
+
+
+def compile_object(compiler, source, include_dirs, flags, output):
+    cmd = [compiler, "-std=c++17", "-c", source, "-o", output] + flags
+    for include_dir in include_dirs:
+        cmd += ["-I", include_dir]
+    subprocess.run(cmd, check=True)
+
+
+def disassemble(objdump, obj):
+    out = subprocess.run([objdump, "-d", "--no-show-raw-insn", obj],
+                         check=True, stdout=subprocess.PIPE, universal_newlines=True).stdout
+    functions = {}
+    current = None
+    for line in out.splitlines():
+        header = re.match(r"^[0-9a-fA-F]+ <(.+)>:$", line)
+        if header:
+            # Cold/split parts (eg. 'pipe_x.cold') are accounted to their parent function
+            current = functions.setdefault(header.group(1).split(".")[0], [])
+            continue
+        instruction = re.match(r"^\s+[0-9a-fA-F]+:\s+(\S+)", line)
+        if current is not None and instruction:
+            current.append(instruction.group(1))
+    return functions
+
+
+def count(instructions):
+    # Padding isn't code
+    code = [i for i in instructions if not i.startswith("nop") and i not in ("xchg", "data16", "cs")]
+    calls = [i for i in code if i in CALL_MNEMONICS]
+    return len(code), len(calls)
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--compiler", required=True)
+    parser.add_argument("--objdump", default="objdump")
+    parser.add_argument("--source", default=os.path.join(os.path.dirname(os.path.abspath(__file__)), "codegen_cases.cpp"))
+    parser.add_argument("--include", action="append", default=[])
+    parser.add_argument("--flags", default="-O2")
+    parser.add_argument("--max-extra-instructions", type=int, default=4,
+                        help="Absolute number of extra instructions tolerated for a pipeline")
+    parser.add_argument("--max-extra-ratio", type=float, default=0.10,
+                        help="Relative number of extra instructions tolerated for a pipeline")
+    args = parser.parse_args()
+
+    with tempfile.TemporaryDirectory() as tmp:
+        obj = os.path.join(tmp, "codegen_cases.o")
+        compile_object(args.compiler, args.source, args.include, args.flags.split(), obj)
+        functions = disassemble(args.objdump, obj)
+
+    cases = sorted(name[len("pipe_"):] for name in functions if name.startswith("pipe_"))
+    if not cases:
+        print("No 'pipe_' functions found in disassembly")
+        return 1
+
+    failed = False
+    print("{:<16}{:>12}{:>12}{:>12}{:>12}".format("case", "pipe instr", "hand instr", "pipe calls", "hand calls"))
+    for case in cases:
+        hand_name = "hand_" + case
+        if hand_name not in functions:
+            print("{:<16}missing '{}'".format(case, hand_name))
+            failed = True
+            continue
+        pipe_instr, pipe_calls = count(functions["pipe_" + case])
+        hand_instr, hand_calls = count(functions[hand_name])
+        allowed = max(args.max_extra_instructions, int(hand_instr * args.max_extra_ratio))
+        ok = pipe_calls <= hand_calls and pipe_instr <= hand_instr + allowed
+        failed |= not ok
+        print("{:<16}{:>12}{:>12}{:>12}{:>12}  {}".format(case, pipe_instr, hand_instr, pipe_calls, hand_calls, "OK" if ok else "FAILED"))
+
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
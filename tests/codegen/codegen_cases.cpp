@@ -0,0 +1,157 @@
+/*
+Pipelines and their hand-written equivalents, compiled & disassembled by check_codegen.py.
+Every 'pipe_<case>' must compile to (roughly) the same machine code as 'hand_<case>'.
+*/
+#include <pipeable/pipeable.hpp>
+#include <pipeable/static_generator.hpp>
+
+#include <optional>
+#include <tuple>
+#include <variant>
+#include <vector>
+
+using pipeable::operator>>=;
+
+namespace
+{
+    struct scale
+    {
+        int operator()(int val) const { return val * factor; }
+        int factor;
+    };
+    struct offset
+    {
+        int operator()(int val) const { return val + amount; }
+        int amount;
+    };
+    struct square
+    {
+        int operator()(int val) const { return val * val; }
+    };
+    struct sum
+    {
+        void operator()(int val) { total += val; }
+        void operator()(float val) { total += static_cast<int>(val); }
+        int total = 0;
+    };
+    struct add
+    {
+        int operator()(int a, int b) const { return a + b; }
+    };
+}
+
+#define CODEGEN_CASE extern "C"
+
+/* Plain callables */
+CODEGEN_CASE int pipe_callables(int val)
+{
+    return val >>= scale{ 3 } >>= offset{ 7 } >>= square{};
+}
+CODEGEN_CASE int hand_callables(int val)
+{
+    return square{}(offset{ 7 }(scale{ 3 }(val)));
+}
+
+/* Pre-composed pipeline */
+CODEGEN_CASE int pipe_composed(int val)
+{
+    const auto pipeline = scale{ 3 } >>= offset{ 7 } >>= square{} >>= offset{ 1 };
+    return val >>= pipeline;
+}
+CODEGEN_CASE int hand_composed(int val)
+{
+    return offset{ 1 }(square{}(offset{ 7 }(scale{ 3 }(val))));
+}
+
+/* Pointer stages (meta::deref_if_ptr) */
+scale g_scale{ 3 };
+const offset g_offset{ 7 };
+
+CODEGEN_CASE int pipe_pointers(int val)
+{
+    return val >>= &g_scale >>= &g_offset >>= square{};
+}
+CODEGEN_CASE int hand_pointers(int val)
+{
+    return square{}(g_offset(g_scale(val)));
+}
+
+/* for_each */
+CODEGEN_CASE int pipe_for_each(const std::vector<int>& vals)
+{
+    sum receiver;
+    vals >>= pipeable::for_each >>= scale{ 3 } >>= &receiver;
+    return receiver.total;
+}
+CODEGEN_CASE int hand_for_each(const std::vector<int>& vals)
+{
+    sum receiver;
+    for (const auto& val : vals)
+    {
+        receiver(scale{ 3 }(val));
+    }
+    return receiver.total;
+}
+
+/* maybe */
+CODEGEN_CASE int pipe_maybe(const std::optional<int>& val)
+{
+    sum receiver;
+    val >>= pipeable::maybe >>= offset{ 7 } >>= &receiver;
+    return receiver.total;
+}
+CODEGEN_CASE int hand_maybe(const std::optional<int>& val)
+{
+    sum receiver;
+    if (val)
+    {
+        receiver(offset{ 7 }(*val));
+    }
+    return receiver.total;
+}
+
+/* visit */
+CODEGEN_CASE int pipe_visit(const std::variant<int, float>& val)
+{
+    sum receiver;
+    val >>= pipeable::visit >>= &receiver;
+    return receiver.total;
+}
+CODEGEN_CASE int hand_visit(const std::variant<int, float>& val)
+{
+    sum receiver;
+    std::visit([&](auto v) { receiver(v); }, val);
+    return receiver.total;
+}
+
+/* unpack */
+CODEGEN_CASE int pipe_unpack(const std::tuple<int, int>& vals)
+{
+    sum receiver;
+    vals >>= pipeable::unpack >>= add{} >>= square{} >>= &receiver;
+    return receiver.total;
+}
+CODEGEN_CASE int hand_unpack(const std::tuple<int, int>& vals)
+{
+    sum receiver;
+    receiver(square{}(std::apply(add{}, vals)));
+    return receiver.total;
+}
+
+/* static_generator */
+CODEGEN_CASE int pipe_static_generator(int val)
+{
+    sum receiver1, receiver2, receiver3;
+    pipeable::static_generator generator(&receiver1, &receiver2, &receiver3);
+    val >>= scale{ 3 } >>= generator;
+    return receiver1.total + receiver2.total * 2 + receiver3.total * 3;
+}
+CODEGEN_CASE int hand_static_generator(int val)
+{
+    sum receiver1, receiver2, receiver3;
+    const auto scaled = scale{ 3 }(val);
+    receiver1(scaled);
+    receiver2(scaled);
+    receiver3(scaled);
+    return receiver1.total + receiver2.total * 2 + receiver3.total * 3;
+}
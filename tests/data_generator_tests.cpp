@@ -1,7 +1,12 @@
 #include <pipeable/data_generator.hpp>
 
 #include <catch2/catch.hpp>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
 #include <variant>
+#include <vector>
 
 using namespace pipeable;
 
@@ -31,6 +36,12 @@ namespace
     };
 }
 
+// Whether 'generator -= callable' is well-formed
+template<typename generator_t, typename callable_t, typename = void>
+constexpr bool can_deregister_v = false;
+template<typename generator_t, typename callable_t>
+constexpr bool can_deregister_v<generator_t, callable_t, std::void_t<decltype(std::declval<generator_t&>() -= std::declval<callable_t>())>> = true;
+
 SCENARIO("Compose pipelines with a data generator")
 {
     GIVEN("a data generator")
@@ -89,6 +100,218 @@ SCENARIO("Compose pipelines with a data generator")
     }
 }
 
+SCENARIO("Register a pipe without copying its stages")
+{
+    // Stands for a stage holding a large table: counts its copies
+    struct table_lookup
+    {
+        explicit table_lookup(int& copies) :
+            copies(&copies)
+        {}
+        table_lookup(const table_lookup& rhs) :
+            copies(rhs.copies)
+        {
+            ++*copies;
+        }
+        table_lookup(table_lookup&&) = default;
+
+        int operator()(int val) const
+        {
+            return val * 10;
+        }
+
+        int* copies;
+    };
+
+    GIVEN("a data generator and a pipe with a heavy stage")
+    {
+        data_generator<int> generator;
+        int copies = 0;
+        int received = 0;
+        auto pipeline = assembly::compose(table_lookup{ copies }, [&](int val) { received = val; });
+        copies = 0;
+
+        WHEN("the pipe is moved into the generator")
+        {
+            generator += std::move(pipeline);
+            generator(1);
+            THEN("its stages are not copied")
+            {
+                REQUIRE(copies == 0);
+                REQUIRE(received == 10);
+            }
+        }
+        WHEN("the pipe is registered by reference")
+        {
+            generator += assembly::by_ref(pipeline);
+            generator(2);
+            THEN("its stages are not copied")
+            {
+                REQUIRE(copies == 0);
+                REQUIRE(received == 20);
+            }
+        }
+    }
+}
+
+SCENARIO("Deregister receivers by subscription")
+{
+    GIVEN("a data generator with multiple lambda receivers")
+    {
+        data_generator<int> generator;
+        int received1 = 0, received2 = 0, received3 = 0;
+        auto sub1 = generator += [&](int val) { received1 = val; };
+        auto sub2 = generator += [&](int val) { received2 = val; };
+        auto sub3 = generator += [&](int val) { received3 = val; };
+
+        WHEN("one receiver is deregistered by its subscription")
+        {
+            generator -= sub2;
+            THEN("only remaining receivers get data")
+            {
+                generator(1);
+                REQUIRE(received1 == 1);
+                REQUIRE(received2 == 0);
+                REQUIRE(received3 == 1);
+            }
+            AND_WHEN("the same subscription is deregistered again after another receiver took its place")
+            {
+                int received4 = 0;
+                generator += [&](int val) { received4 = val; };
+                generator -= sub2;
+                THEN("the new receiver is not affected")
+                {
+                    generator(1);
+                    REQUIRE(received4 == 1);
+                }
+            }
+        }
+        WHEN("all receivers are deregistered in any order")
+        {
+            generator -= sub1;
+            generator -= sub3;
+            generator -= sub2;
+            THEN("no receiver gets data")
+            {
+                generator(1);
+                REQUIRE(received1 + received2 + received3 == 0);
+            }
+        }
+        WHEN("a pointer receiver is deregistered")
+        {
+            int_to_int receiver;
+            generator += &receiver;
+            generator -= &receiver;
+            THEN("lambda receivers still get data")
+            {
+                generator(1);
+                REQUIRE(received1 == 1);
+                REQUIRE(received2 == 1);
+                REQUIRE(received3 == 1);
+                REQUIRE(receiver.receivedValue == false);
+            }
+        }
+        THEN("only pointer receivers can be deregistered by callable (others by subscription)")
+        {
+            auto lambda = [](int) {};
+            static_assert(can_deregister_v<data_generator<int>, int_to_int*>);
+            static_assert(!can_deregister_v<data_generator<int>, decltype(lambda)>);
+            static_assert(!can_deregister_v<data_generator<int, std::string>, decltype(lambda)&>);
+            static_assert(!can_deregister_v<data_generator<int, std::string>, int_and_string_receiver>);
+            static_assert(can_deregister_v<data_generator<int, std::string>, int_and_string_receiver*>);
+        }
+    }
+    GIVEN("a generator outputting int & string")
+    {
+        data_generator<int, std::string> generator;
+        WHEN("a receiver callable with both is deregistered by its subscription")
+        {
+            int_and_string_receiver receiver;
+            auto sub = generator += &receiver;
+            generator -= sub;
+            THEN("it no longer receives either")
+            {
+                generator(1);
+                generator("hello");
+                REQUIRE(receiver.receivedInt == 0);
+                REQUIRE(receiver.receivedStr == "");
+            }
+        }
+    }
+}
+
+SCENARIO("Transactional modification of a data generator")
+{
+    GIVEN("a data generator with a registered receiver")
+    {
+        data_generator<int> generator;
+        int_to_int registered;
+        generator += &registered;
+        WHEN("receivers are registered & deregistered in one transaction")
+        {
+            std::vector<int_to_int> receivers(3);
+            generator.modify([&](auto& tx) {
+                for (auto& receiver : receivers)
+                {
+                    tx += &receiver;
+                }
+                tx -= &registered;
+            });
+            THEN("all modifications are applied")
+            {
+                generator(1);
+                REQUIRE(registered.receivedValue == false);
+                for (auto& receiver : receivers)
+                {
+                    REQUIRE(receiver.receivedValue == true);
+                }
+            }
+        }
+        WHEN("a transaction throws")
+        {
+            int_to_int other;
+            REQUIRE_THROWS_AS(generator.modify([&](auto& tx) {
+                tx += &other;
+                tx -= &registered;
+                throw std::runtime_error("aborted");
+            }), std::runtime_error);
+            THEN("none of its modifications are applied")
+            {
+                generator(1);
+                REQUIRE(registered.receivedValue == true);
+                REQUIRE(other.receivedValue == false);
+            }
+        }
+    }
+    GIVEN("a data generator with receivers registered by subscription")
+    {
+        data_generator<int> generator;
+        std::vector<int> order;
+        auto sub0 = generator += [&](int) { order.push_back(0); };
+        auto sub1 = generator += [&](int) { order.push_back(1); };
+        generator += [&](int) { order.push_back(2); };
+        generator += [&](int) { order.push_back(3); };
+        WHEN("a transaction throws after erasing & registering receivers")
+        {
+            REQUIRE_THROWS_AS(generator.modify([&](auto& tx) {
+                tx -= sub1;
+                tx += [&order](int) { order.push_back(4); };
+                tx -= sub0;
+                throw std::runtime_error("aborted");
+            }), std::runtime_error);
+            THEN("receivers are restored in order, and so are their subscriptions")
+            {
+                generator(1);
+                REQUIRE(order == std::vector<int>{ 0, 1, 2, 3 });
+                generator -= sub1;
+                order.clear();
+                generator(1);
+                REQUIRE(order == std::vector<int>{ 0, 3, 2 });
+            }
+        }
+    }
+}
+
 SCENARIO("Non const reference output generator")
 {
     GIVEN("a data generator outputting non-const reference")
@@ -309,4 +532,86 @@ SCENARIO("Chaining generators")
             }
         }
     }
-}
\ No newline at end of file
+}
+SCENARIO("Batch emission")
+{
+    GIVEN("a data generator outputting int")
+    {
+        data_generator<int> generator;
+        const std::vector<int> values = { 1, 2, 3 };
+
+        WHEN("piped to a batch receiver")
+        {
+            struct receiver_t : batch_receiver
+            {
+                std::vector<int> received;
+                int batchCalls = 0;
+                void operator()(int val) { received.push_back(val); }
+                void operator()(span<const int> batch)
+                {
+                    ++batchCalls;
+                    received.insert(received.end(), batch.begin(), batch.end());
+                }
+            } receiver;
+
+            generator += &receiver;
+            THEN("it receives all values in a single call")
+            {
+                generator.emit_batch(values);
+                REQUIRE(receiver.batchCalls == 1);
+                REQUIRE(receiver.received == values);
+            }
+            THEN("it still receives single values")
+            {
+                generator(1);
+                REQUIRE(receiver.batchCalls == 0);
+                REQUIRE(receiver.received == std::vector<int>{ 1 });
+            }
+        }
+        WHEN("piped to receivers not accepting batches")
+        {
+            std::vector<int> received1, received2;
+            auto receiver1 = [&](int val) { received1.push_back(val); };
+            generator += &receiver1;
+            generator += [&](const auto& val) { received2.push_back(val); };
+            THEN("they receive each value in order")
+            {
+                generator.emit_batch(values);
+                REQUIRE(received1 == values);
+                REQUIRE(received2 == values);
+            }
+        }
+    }
+    GIVEN("a data generator outputting by r-value")
+    {
+        data_generator<std::string&&> generator;
+        WHEN("piped to multiple receivers moving from input")
+        {
+            std::string received1, received2;
+            generator += [&](std::string&& val) { received1 += std::move(val); };
+            generator += [&](std::string&& val) { received2 += std::move(val); };
+            THEN("each receiver gets its own copy of every value")
+            {
+                const std::vector<std::string> values = { "a", "b" };
+                generator.emit_batch(values);
+                REQUIRE(received1 == "ab");
+                REQUIRE(received2 == "ab");
+                REQUIRE(values == std::vector<std::string>{ "a", "b" });
+            }
+        }
+    }
+    GIVEN("a data generator outputting non-const reference")
+    {
+        data_generator<int&> generator;
+        WHEN("piped to a mutating receiver")
+        {
+            generator += [](int& val) { val *= 10; };
+            THEN("values in the batch are mutated")
+            {
+                std::vector<int> values = { 1, 2 };
+                generator.emit_batch(values);
+                REQUIRE(values == std::vector<int>{ 10, 20 });
+            }
+        }
+    }
+}
@@ -5,6 +5,8 @@
 #include <type_traits>
 #include <string>
 #include <chrono>
+#include <memory>
+#include <vector>
 
 using namespace pipeable;
 using a_clock_t = std::chrono::system_clock;
@@ -52,6 +54,119 @@ namespace
 
     template<typename T>
     struct hello;
+
+    // Counts next() & next_batch() calls, pulling 'count' ints
+    struct counting_source final : public data_source<int>
+    {
+        explicit counting_source(int count, bool batched) :
+            count_(count),
+            batched_(batched)
+        {}
+
+        std::optional<int> next() override
+        {
+            ++nextCalls;
+            return current_ < count_ ? std::optional<int>(current_++) : std::nullopt;
+        }
+
+        std::size_t next_batch(span<int> values) override
+        {
+            ++batchCalls;
+            if (!batched_)
+            {
+                return data_source<int>::next_batch(values);
+            }
+            std::size_t pulled = 0;
+            for (; pulled < values.size() && current_ < count_; ++pulled)
+            {
+                values[pulled] = current_++;
+            }
+            return pulled;
+        }
+
+        bool supports_batch() const noexcept override
+        {
+            return batched_;
+        }
+
+        int nextCalls = 0;
+        int batchCalls = 0;
+
+    private:
+        int count_;
+        bool batched_;
+        int current_ = 0;
+    };
+
+    // Logs each value read, pulling 'count' ints (again once all are pulled). Not final, so may be pulled through a base reference.
+    struct logging_source : public data_source<int>
+    {
+        logging_source(std::vector<std::string>& log, int count) :
+            log_(log),
+            count_(count)
+        {}
+
+        std::optional<int> next() override
+        {
+            if (current_ == count_)
+            {
+                current_ = 0;
+                return std::nullopt;
+            }
+            log_.push_back("read " + std::to_string(current_));
+            return current_++;
+        }
+
+    private:
+        std::vector<std::string>& log_;
+        int count_;
+        int current_ = 0;
+    };
+
+    // Move-only payloads: 'count' buffers of a single int
+    using buffer_t = std::unique_ptr<std::vector<int>>;
+    struct buffer_source final : public data_source<buffer_t>
+    {
+        explicit buffer_source(int count, bool batched) :
+            count_(count),
+            batched_(batched)
+        {}
+
+        std::optional<buffer_t> next() override
+        {
+            return current_ < count_ ? std::optional<buffer_t>(std::make_unique<std::vector<int>>(1, current_++)) : std::nullopt;
+        }
+
+        std::size_t next_batch(span<buffer_t> values) override
+        {
+            if (!batched_)
+            {
+                return data_source<buffer_t>::next_batch(values);
+            }
+            std::size_t pulled = 0;
+            for (; pulled < values.size() && current_ < count_; ++pulled)
+            {
+                values[pulled] = std::make_unique<std::vector<int>>(1, current_++);
+            }
+            return pulled;
+        }
+
+        bool supports_batch() const noexcept override
+        {
+            return batched_;
+        }
+
+    private:
+        int count_;
+        bool batched_;
+        int current_ = 0;
+    };
+
+    // Not equality comparable
+    struct point
+    {
+        int x, y;
+    };
 }
 
 SCENARIO("Compose pipeline stages with first stage generating data")
@@ -100,4 +215,175 @@ SCENARIO("Compose pipeline stages with first stage generating data")
             }
         }
     }
+}
+
+SCENARIO("Pull values from a data source in batches")
+{
+    GIVEN("a data source overriding next_batch")
+    {
+        counting_source source{ 1000, true };
+        WHEN("piped as: data_source >>= for_each >>= receiver")
+        {
+            std::vector<int> vals;
+            source >>= for_each >>= [&](int val) { vals.push_back(val); };
+            THEN("values are pulled one block at a time, in order")
+            {
+                REQUIRE(vals.size() == 1000);
+                REQUIRE(vals[999] == 999);
+                REQUIRE(source.nextCalls == 0);
+                // Full blocks until none is pulled
+                REQUIRE(source.batchCalls == (1000 + data_source<int>::batch_size - 1) / data_source<int>::batch_size + 1);
+            }
+        }
+    }
+    GIVEN("a data source only implementing next")
+    {
+        counting_source source{ 10, false };
+        WHEN("pulled in a batch larger than its values")
+        {
+            std::vector<int> vals(16);
+            const auto pulled = source.next_batch(vals);
+            THEN("the default pulls values through next until there are none left")
+            {
+                REQUIRE(pulled == 10);
+                REQUIRE(vals[9] == 9);
+                REQUIRE(source.nextCalls == 11);
+                REQUIRE(source.next_batch(vals) == 0);
+            }
+        }
+        WHEN("iterated")
+        {
+            int sum = 0;
+            for (auto val : source)
+            {
+                sum += val;
+            }
+            THEN("each value is pulled through next")
+            {
+                REQUIRE(sum == 45);
+                REQUIRE(source.batchCalls == 0);
+            }
+        }
+        WHEN("piped through a data_source reference (dynamic type unknown)")
+        {
+            int sum = 0;
+            static_cast<data_source<int>&>(source) >>= for_each >>= [&](int val) { sum += val; };
+            THEN("it doesn't support batches, so each value is pulled through next")
+            {
+                REQUIRE(sum == 45);
+                REQUIRE(source.batchCalls == 0);
+                REQUIRE(source.nextCalls == 11);
+            }
+        }
+    }
+    GIVEN("a data source overriding next_batch, piped through a data_source reference")
+    {
+        counting_source source{ 1000, true };
+        std::vector<int> vals;
+        static_cast<data_source<int>&>(source) >>= for_each >>= [&](int val) { vals.push_back(val); };
+        THEN("it supports batches, so values are pulled one block at a time")
+        {
+            REQUIRE(vals.size() == 1000);
+            REQUIRE(vals[999] == 999);
+            REQUIRE(source.nextCalls == 0);
+            REQUIRE(source.batchCalls == (1000 + data_source<int>::batch_size - 1) / data_source<int>::batch_size + 1);
+        }
+    }
+    GIVEN("a data source only implementing next, logging each value read")
+    {
+        std::vector<std::string> log;
+        logging_source source{ log, 3 };
+        WHEN("piped as: data_source >>= for_each >>= receiver, directly & through a data_source reference")
+        {
+            source >>= for_each >>= [&](int val) { log.push_back("deliver " + std::to_string(val)); };
+            static_cast<data_source<int>&>(source) >>= for_each >>= [&](int val) { log.push_back("deliver " + std::to_string(val)); };
+            THEN("each value is delivered before the next one is read")
+            {
+                const std::vector<std::string> once{ "read 0", "deliver 0", "read 1", "deliver 1", "read 2", "deliver 2" };
+                std::vector<std::string> twice = once;
+                twice.insert(twice.end(), once.begin(), once.end());
+                REQUIRE(log == twice);
+            }
+        }
+    }
+}
+
+SCENARIO("Iterate a data source until its end")
+{
+    GIVEN("a data source with equal values in a row")
+    {
+        my_source<int> source{ 7, 7, 7 };
+        WHEN("iterated")
+        {
+            int count = 0;
+            for (auto val : source)
+            {
+                count += val == 7;
+            }
+            THEN("only an empty optional ends the iteration")
+            {
+                REQUIRE(count == 3);
+            }
+        }
+    }
+    GIVEN("a data source of values which aren't equality comparable")
+    {
+        my_source<point> source{ { 1, 2 }, { 1, 2 } };
+        WHEN("iterated")
+        {
+            int sum = 0;
+            for (auto it = source.begin(); it != source.end(); ++it)
+            {
+                sum += it->x + it->y;
+            }
+            THEN("each value is iterated")
+            {
+                REQUIRE(sum == 6);
+            }
+        }
+    }
+}
+
+SCENARIO("Pull move-only values from a data source")
+{
+    GIVEN("a data source of unique_ptr buffers")
+    {
+        WHEN("iterated")
+        {
+            buffer_source source{ 3, false };
+            std::vector<buffer_t> buffers;
+            for (auto&& buffer : source)
+            {
+                buffers.push_back(std::move(buffer));
+            }
+            THEN("values are handed out as r-values, and moved")
+            {
+                REQUIRE(std::is_same_v<decltype(*source.begin()), buffer_t&&>);
+                REQUIRE(buffers.size() == 3);
+                REQUIRE((*buffers[2])[0] == 2);
+            }
+        }
+        WHEN("piped as: data_source >>= for_each >>= stage >>= receiver")
+        {
+            buffer_source source{ 300, false };
+            std::vector<buffer_t> buffers;
+            source >>= for_each >>= [](buffer_t&& buffer) { buffer->push_back(1); return std::move(buffer); } >>= [&](buffer_t&& buffer) { buffers.push_back(std::move(buffer)); };
+            THEN("buffers flow through without copies")
+            {
+                REQUIRE(buffers.size() == 300);
+                REQUIRE(*buffers[299] == std::vector<int>{ 299, 1 });
+            }
+        }
+        WHEN("pulled in blocks by for_each")
+        {
+            buffer_source source{ 300, true };
+            std::vector<buffer_t> buffers;
+            source >>= for_each >>= [&](buffer_t&& buffer) { buffers.push_back(std::move(buffer)); };
+            THEN("buffers are moved out of the block")
+            {
+                REQUIRE(buffers.size() == 300);
+                REQUIRE((*buffers[299])[0] == 299);
+            }
+        }
+    }
 }
\ No newline at end of file
@@ -0,0 +1,230 @@
+#include <pipeable/data_generator.hpp>
+#include <pipeable/internal/delegate.hpp>
+
+#include <catch2/catch.hpp>
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdlib>
+#include <memory>
+#include <new>
+
+using namespace pipeable;
+
+namespace
+{
+    thread_local std::size_t allocationCount = 0;
+
+    // Count allocations made by the current thread while 'func' runs
+    template<typename func_t>
+    std::size_t count_allocations(func_t&& func)
+    {
+        const auto before = allocationCount;
+        func();
+        return allocationCount - before;
+    }
+
+    struct counter
+    {
+        void operator()(int val) { sum += val; }
+        int sum = 0;
+    };
+}
+
+// Built as its own executable (pipeable_allocation_tests): every form of the global operators is replaced, consistently
+namespace
+{
+    void* counted_alloc(std::size_t size)
+    {
+        ++allocationCount;
+        return std::malloc(size ? size : 1);
+    }
+
+    void* counted_aligned_alloc(std::size_t size, std::align_val_t align)
+    {
+        ++allocationCount;
+        const auto alignment = std::max(static_cast<std::size_t>(align), sizeof(void*));
+        // aligned_alloc requires a size multiple of the alignment
+        return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+    }
+
+    template<typename ptr_t>
+    ptr_t throw_if_null(ptr_t ptr)
+    {
+        if (!ptr)
+        {
+            throw std::bad_alloc();
+        }
+        return ptr;
+    }
+}
+
+void* operator new(std::size_t size) { return throw_if_null(counted_alloc(size)); }
+void* operator new[](std::size_t size) { return throw_if_null(counted_alloc(size)); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return counted_alloc(size); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return counted_alloc(size); }
+void* operator new(std::size_t size, std::align_val_t align) { return throw_if_null(counted_aligned_alloc(size, align)); }
+void* operator new[](std::size_t size, std::align_val_t align) { return throw_if_null(counted_aligned_alloc(size, align)); }
+void* operator new(std::size_t size, std::align_val_t align, const std::nothrow_t&) noexcept { return counted_aligned_alloc(size, align); }
+void* operator new[](std::size_t size, std::align_val_t align, const std::nothrow_t&) noexcept { return counted_aligned_alloc(size, align); }
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { std::free(ptr); }
+
+SCENARIO("Inline delegate")
+{
+    GIVEN("a lambda capturing state fitting the inline capacity")
+    {
+        int a = 0, b = 0, c = 0;
+        auto lambda = [&a, &b, &c](int val) { a = b = c = val; };
+        static_assert(sizeof(lambda) <= impl::delegate<void(int)>::capacity);
+
+        WHEN("stored in a delegate")
+        {
+            THEN("no allocation is made")
+            {
+                REQUIRE(count_allocations([&] { impl::delegate<void(int)> d = lambda; }) == 0);
+            }
+            AND_WHEN("the delegate is copied and invoked")
+            {
+                impl::delegate<void(int)> d = lambda;
+                std::size_t allocations = count_allocations([&] {
+                    auto copy = d;
+                    copy(5);
+                });
+                THEN("no allocation is made")
+                {
+                    REQUIRE(allocations == 0);
+                }
+                THEN("the lambda is invoked")
+                {
+                    REQUIRE(a == 5);
+                    REQUIRE(c == 5);
+                }
+            }
+        }
+    }
+    GIVEN("a callable with non-trivial state fitting the inline capacity")
+    {
+        auto ptr = std::make_shared<int>(0);
+        auto lambda = [ptr](int val) { *ptr = val; };
+
+        WHEN("stored in a delegate, copied and destroyed")
+        {
+            std::size_t allocations = count_allocations([&] {
+                impl::delegate<void(int)> d = lambda;
+                auto copy = d;
+                auto moved = std::move(copy);
+                moved(2);
+            });
+            THEN("no allocation is made")
+            {
+                REQUIRE(allocations == 0);
+            }
+            THEN("the state is shared and released")
+            {
+                REQUIRE(*ptr == 2);
+                REQUIRE(ptr.use_count() == 2);
+            }
+        }
+    }
+    GIVEN("a callable invocable with multiple signatures")
+    {
+        struct callable_t
+        {
+            void operator()(int val) { *out = val; }
+            void operator()(int lhs, int rhs) { *out = lhs + rhs; }
+            int* out;
+        };
+        int out = 0;
+
+        WHEN("stored in a delegate with both signatures")
+        {
+            impl::basic_delegate<impl::delegate<void(int)>::capacity, void(int), void(int, int)> d = callable_t{ &out };
+            THEN("each signature invokes the matching overload")
+            {
+                d(1);
+                REQUIRE(out == 1);
+                d(1, 2);
+                REQUIRE(out == 3);
+            }
+        }
+    }
+    GIVEN("a callable larger than the inline capacity")
+    {
+        std::array<int, 64> big{};
+        auto lambda = [big](int& out) { out = big[63] + 1; };
+
+        WHEN("stored in a delegate")
+        {
+            impl::delegate<void(int&)> d;
+            std::size_t allocations = count_allocations([&] { d = lambda; });
+            THEN("it is allocated once")
+            {
+                REQUIRE(allocations == 1);
+            }
+            THEN("it is invocable")
+            {
+                int out = 0;
+                d(out);
+                REQUIRE(out == 1);
+            }
+        }
+    }
+}
+
+SCENARIO("Data generator receiver allocations")
+{
+    GIVEN("a data generator with a registered receiver")
+    {
+        data_generator<int> generator;
+        counter first;
+        generator += &first;
+
+        WHEN("emitting to registered receivers")
+        {
+            counter second;
+            generator += [&second](int val) { second(val); };
+
+            THEN("no allocation is made")
+            {
+                REQUIRE(count_allocations([&] { generator(1); }) == 0);
+                REQUIRE(first.sum == 1);
+                REQUIRE(second.sum == 1);
+            }
+            THEN("no allocation is made when emitting a batch")
+            {
+                const int values[] = { 1, 2 };
+                REQUIRE(count_allocations([&] { generator.emit_batch(values); }) == 0);
+                REQUIRE(first.sum == 3);
+                REQUIRE(second.sum == 3);
+            }
+        }
+        WHEN("registering a capturing lambda")
+        {
+            int a = 0, b = 0, c = 0;
+            auto lambda = [&a, &b, &c](int val) { a = b = c = val; };
+            // Only allocations are growth of the receiver list arrays (invokers, identifiers, positions & slots: capacity 1 -> 2)
+            THEN("it costs no more allocations than registering a pointer")
+            {
+                data_generator<int> other;
+                counter receiver;
+                other += &receiver;
+                const auto pointerAllocations = count_allocations([&] { other += &first; });
+                const auto lambdaAllocations = count_allocations([&] { generator += lambda; });
+                REQUIRE(lambdaAllocations == pointerAllocations);
+                REQUIRE(lambdaAllocations <= 4);
+            }
+        }
+    }
+}
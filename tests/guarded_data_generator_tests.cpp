@@ -1,9 +1,16 @@
 #include <pipeable/guarded_data_generator.hpp>
+#include <pipeable/thread_pool.hpp>
 
 #include <catch2/catch.hpp>
 #include <atomic>
 #include <chrono>
+#include <cstdint>
+#include <memory>
+#include <set>
+#include <stdexcept>
+#include <mutex>
 #include <thread>
+#include <vector>
 
 using namespace pipeable;
 
@@ -87,4 +94,262 @@ SCENARIO("Thread safe data generator")
             sendingThread.join();
         }
     }
-}
\ No newline at end of file
+}
+
+SCENARIO("Receivers modifying a thread safe data generator while it emits")
+{
+    GIVEN("a thread safe data generator")
+    {
+        guarded_data_generator<int> generator;
+        WHEN("a receiver deregisters itself (and registers another) when invoked")
+        {
+            int receivedCount = 0;
+            int otherReceivedCount = 0;
+            auto other = [&](int) { ++otherReceivedCount; };
+            subscription<int> sub;
+            sub = generator += [&](int) {
+                ++receivedCount;
+                generator -= sub;
+                generator += other;
+            };
+            THEN("the snapshot being emitted to stays valid, and modifications apply to the next emission")
+            {
+                generator(1);
+                REQUIRE(receivedCount == 1);
+                REQUIRE(otherReceivedCount == 0);
+                generator(1);
+                REQUIRE(receivedCount == 1);
+                REQUIRE(otherReceivedCount == 1);
+            }
+        }
+    }
+}
+
+SCENARIO("Epoch based reclamation")
+{
+    GIVEN("an epoch domain")
+    {
+        auto& domain = impl::epoch_domain::instance();
+        WHEN("an object is retired while a reader is pinned")
+        {
+            std::uint64_t tag = 0;
+            {
+                auto outer = domain.pin();
+                {
+                    auto inner = domain.pin();
+                }
+                tag = domain.advance();
+                THEN("it is not reclaimable while the reader (outermost pin) is active")
+                {
+                    REQUIRE(tag >= domain.min_active_epoch());
+                }
+            }
+            THEN("it is reclaimable once the reader is unpinned")
+            {
+                REQUIRE(tag < domain.min_active_epoch());
+            }
+        }
+    }
+}
+
+SCENARIO("Transactional modification of a thread safe data generator")
+{
+    GIVEN("a thread safe data generator outputting int & string")
+    {
+        guarded_data_generator<int, std::string> generator;
+        int_and_string_receiver receiver1, receiver2;
+        int receivedInt = 0;
+        WHEN("multiple receivers are (de)registered in one transaction")
+        {
+            subscription<int, std::string> sub;
+            generator.modify([&](auto& tx) {
+                tx += &receiver1;
+                sub = tx += &receiver2;
+                tx += [&](int val) { receivedInt = val; };
+                tx -= sub;
+            });
+            THEN("all modifications are applied")
+            {
+                generator(1);
+                generator("hello");
+                REQUIRE(receiver1.receivedInt == 1);
+                REQUIRE(receiver1.receivedStr == "hello");
+                REQUIRE(receiver2.receivedInt == 0);
+                REQUIRE(receiver2.receivedStr == "");
+                REQUIRE(receivedInt == 1);
+            }
+        }
+        WHEN("a transaction throws")
+        {
+            generator += &receiver1;
+            REQUIRE_THROWS_AS(generator.modify([&](auto& tx) {
+                tx += &receiver2;
+                tx -= &receiver1;
+                throw std::runtime_error("aborted");
+            }), std::runtime_error);
+            AND_WHEN("another transaction succeeds")
+            {
+                generator += [&](int val) { receivedInt = val; };
+                THEN("only modifications of the throwing transaction are dropped")
+                {
+                    generator(1);
+                    generator("hello");
+                    REQUIRE(receiver1.receivedInt == 1);
+                    REQUIRE(receiver1.receivedStr == "hello");
+                    REQUIRE(receiver2.receivedInt == 0);
+                    REQUIRE(receiver2.receivedStr == "");
+                    REQUIRE(receivedInt == 1);
+                }
+            }
+        }
+    }
+    GIVEN("a thread safe data generator")
+    {
+        guarded_data_generator<int> generator;
+        WHEN("multiple threads register receivers concurrently")
+        {
+            std::atomic_int receivedCount = 0;
+            std::atomic_bool start = false;
+            const auto threadCount = 8;
+            const auto registerCount = 100;
+            std::vector<std::thread> threads;
+            for (auto i = 0; i < threadCount; ++i)
+            {
+                threads.emplace_back([&] {
+                    while (!start) { std::this_thread::yield(); }
+                    for (auto j = 0; j < registerCount; ++j)
+                    {
+                        generator += [&](int) { ++receivedCount; };
+                    }
+                });
+            }
+            start = true;
+            for (auto& thread : threads)
+            {
+                thread.join();
+            }
+            THEN("no registration is lost")
+            {
+                generator(1);
+                REQUIRE(receivedCount == threadCount * registerCount);
+            }
+        }
+    }
+}
+
+SCENARIO("Parallel fan-out of an emission")
+{
+    GIVEN("a thread safe data generator fanning out over a thread pool, with many receivers")
+    {
+        thread_pool pool{ 4 };
+        guarded_data_generator<int> generator;
+        const auto receiverCount = 100;
+        std::atomic_int receivedSum = 0;
+        std::mutex mutex;
+        std::set<std::thread::id> threads;
+        for (auto i = 0; i < receiverCount; ++i)
+        {
+            generator += [&](int value) {
+                receivedSum += value;
+                std::scoped_lock lock{ mutex };
+                threads.insert(std::this_thread::get_id());
+            };
+        }
+
+        WHEN("it emits, waiting for all receivers")
+        {
+            generator.set_fan_out({ &pool, 64, 8, true });
+            generator(2);
+            THEN("all receivers have received the value when emission returns")
+            {
+                REQUIRE(receivedSum == 2 * receiverCount);
+            }
+        }
+        WHEN("it emits without waiting")
+        {
+            generator.set_fan_out({ &pool, 64, 8, false });
+            {
+                int value = 3;
+                generator(value);
+            }
+            pool.wait_idle();
+            THEN("all receivers receive (a copy of) the value on the pool")
+            {
+                REQUIRE(receivedSum == 3 * receiverCount);
+                REQUIRE(threads.count(std::this_thread::get_id()) == 0);
+            }
+        }
+        WHEN("it emits with fewer receivers than the threshold")
+        {
+            generator.set_fan_out({ &pool, receiverCount + 1, 8, true });
+            generator(1);
+            THEN("receivers are invoked sequentially on the emitting thread")
+            {
+                REQUIRE(receivedSum == receiverCount);
+                REQUIRE(threads.size() == 1);
+                REQUIRE(threads.count(std::this_thread::get_id()) == 1);
+            }
+        }
+        WHEN("it emits without waiting while receivers are being modified")
+        {
+            generator.set_fan_out({ &pool, 64, 8, false });
+            generator(1);
+            for (auto i = 0; i < 10; ++i)
+            {
+                auto sub = generator += [](int) {};
+                generator -= sub;
+            }
+            pool.wait_idle();
+            THEN("the snapshot in use stays alive until all of its receivers were invoked")
+            {
+                REQUIRE(receivedSum == receiverCount);
+            }
+        }
+        WHEN("a receiver throws")
+        {
+            generator += [](int) { throw std::runtime_error("receiver"); };
+            AND_WHEN("it emits, waiting for all receivers")
+            {
+                generator.set_fan_out({ &pool, 64, 1, true });
+                REQUIRE_THROWS_AS(generator(2), std::runtime_error);
+                THEN("the exception is rethrown once all other receivers have received the value")
+                {
+                    REQUIRE(receivedSum == 2 * receiverCount);
+                    REQUIRE(generator.fan_out_failures() == 1);
+                }
+            }
+            AND_WHEN("it emits without waiting")
+            {
+                generator.set_fan_out({ &pool, 64, 1, false });
+                generator(3);
+                pool.wait_idle();
+                THEN("the exception is dropped and counted, all other receivers receive the value")
+                {
+                    REQUIRE(receivedSum == 3 * receiverCount);
+                    REQUIRE(generator.fan_out_failures() == 1);
+                }
+            }
+        }
+    }
+    GIVEN("a thread safe data generator outputting a move-only value by const reference, with many receivers")
+    {
+        thread_pool pool{ 4 };
+        guarded_data_generator<const std::unique_ptr<int>&> generator;
+        const auto receiverCount = 100;
+        std::atomic_int receivedSum = 0;
+        for (auto i = 0; i < receiverCount; ++i)
+        {
+            generator += [&](const std::unique_ptr<int>& val) { receivedSum += *val; };
+        }
+
+        WHEN("it emits, configured not to wait")
+        {
+            generator.set_fan_out({ &pool, 64, 8, false });
+            generator(std::make_unique<int>(2));
+            THEN("it waits for all receivers anyway (the value can't be copied)")
+            {
+                REQUIRE(receivedSum == 2 * receiverCount);
+            }
+        }
+    }
+}
@@ -0,0 +1,130 @@
+#include <pipeable/pipeable.hpp>
+#include <pipeable/mmap_line_source.hpp>
+#include <pipeable/parallel_for_each.hpp>
+
+#include <catch2/catch.hpp>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+using namespace pipeable;
+
+namespace
+{
+    // File with the given content (in the working directory), removed on destruction
+    struct temp_file
+    {
+        explicit temp_file(const std::string& content) :
+            path("pipeable_mmap_" + std::to_string(++counter) + ".txt")
+        {
+            std::ofstream(path, std::ios::binary) << content;
+        }
+        ~temp_file()
+        {
+            std::remove(path.c_str());
+        }
+
+        std::string path;
+        static inline int counter = 0;
+    };
+}
+
+SCENARIO("Memory mapped line source")
+{
+    GIVEN("a file of lines, the last one without newline")
+    {
+        temp_file file{ "first\n\nthird line\nlast" };
+        mmap_line_source source{ file.path };
+        WHEN("piped as: mmap_line_source >>= for_each >>= receiver")
+        {
+            std::vector<std::string_view> lines;
+            source >>= for_each >>= [&](std::string_view line) { lines.push_back(line); };
+            THEN("each line is pulled, without its separator")
+            {
+                REQUIRE(lines == std::vector<std::string_view>{ "first", "", "third line", "last" });
+            }
+        }
+    }
+    GIVEN("a file ending with a newline")
+    {
+        temp_file file{ "a\nb\n" };
+        mmap_line_source source{ file.path };
+        THEN("there is no empty last line")
+        {
+            REQUIRE(source.next() == "a");
+            REQUIRE(source.next() == "b");
+            REQUIRE_FALSE(source.next().has_value());
+        }
+    }
+    GIVEN("an empty file")
+    {
+        temp_file file{ "" };
+        mmap_line_source source{ file.path };
+        THEN("there are no lines")
+        {
+            REQUIRE_FALSE(source.next().has_value());
+            REQUIRE(source.try_split() == nullptr);
+        }
+    }
+    GIVEN("a missing file")
+    {
+        THEN("construction throws")
+        {
+            REQUIRE_THROWS_AS(mmap_line_source{ "/nonexistent/pipeable.txt" }, std::system_error);
+        }
+    }
+    GIVEN("a file of many pages")
+    {
+        std::string content;
+        constexpr int lineCount = 20'000;
+        for (int i = 0; i < lineCount; ++i)
+        {
+            content += "record " + std::to_string(i) + "\n";
+        }
+        temp_file file{ content };
+        mmap_line_source source{ file.path };
+
+        WHEN("split in 4")
+        {
+            auto parts = source.split(4);
+            THEN("parts start on page-aligned lines, and cover all lines once")
+            {
+                REQUIRE(parts.size() == 3);
+                std::vector<std::string_view> lines;
+                source >>= for_each >>= [&](std::string_view line) { lines.push_back(line); };
+                for (auto& part : parts)
+                {
+                    const auto first = *part->next();
+                    const auto offset = static_cast<std::size_t>(first.data() - lines.front().data());
+                    // Starts on the line following a page boundary (lines are 16 bytes at most)
+                    REQUIRE(offset % mmap_line_source::page_size() < 16);
+                    REQUIRE(*(first.data() - 1) == '\n');
+                    lines.push_back(first);
+                    *part >>= for_each >>= [&](std::string_view line) { lines.push_back(line); };
+                }
+                REQUIRE(lines.size() == lineCount);
+                REQUIRE(lines.back() == "record 19999");
+            }
+        }
+        WHEN("consumed in parallel")
+        {
+            thread_pool pool{ 3 };
+            std::mutex mutex;
+            std::size_t count = 0, bytes = 0;
+            source >>= parallel_for_each(pool, 4) >>= [&](std::string_view line) {
+                std::scoped_lock lock{ mutex };
+                ++count;
+                bytes += line.size() + 1;
+            };
+            THEN("all lines are pulled")
+            {
+                REQUIRE(count == lineCount);
+                REQUIRE(bytes == content.size());
+            }
+        }
+    }
+}
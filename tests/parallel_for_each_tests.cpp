@@ -0,0 +1,190 @@
+#include <pipeable/pipeable.hpp>
+#include <pipeable/parallel_for_each.hpp>
+
+#include <catch2/catch.hpp>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace pipeable;
+
+namespace
+{
+    // Pulls the values of [begin, end), splitting off the upper half
+    struct range_source final : public data_source<int>
+    {
+        range_source(int begin, int end, int throwAt = -1) :
+            current_(begin),
+            end_(end),
+            throwAt_(throwAt)
+        {}
+
+        std::optional<int> next() override
+        {
+            if (current_ == throwAt_)
+            {
+                throw std::runtime_error("bad record");
+            }
+            return current_ < end_ ? std::optional<int>(current_++) : std::nullopt;
+        }
+
+        std::unique_ptr<data_source<int>> try_split() override
+        {
+            if (end_ - current_ < 2)
+            {
+                return nullptr;
+            }
+            const auto middle = current_ + (end_ - current_) / 2;
+            auto upper = std::make_unique<range_source>(middle, end_, throwAt_);
+            end_ = middle;
+            return upper;
+        }
+
+    private:
+        int current_;
+        int end_;
+        int throwAt_;
+    };
+
+    // Thread safe collection of values, and of the threads they were received on
+    struct collector
+    {
+        void operator()(int val)
+        {
+            std::scoped_lock lock{ mutex };
+            vals.insert(val);
+            threads.insert(std::this_thread::get_id());
+            ++count;
+        }
+
+        std::mutex mutex;
+        std::multiset<int> vals;
+        std::set<std::thread::id> threads;
+        int count = 0;
+    };
+}
+
+SCENARIO("Split a data source")
+{
+    GIVEN("a source over a range of values")
+    {
+        range_source source{ 0, 100 };
+        WHEN("split in 4")
+        {
+            auto parts = source.split(4);
+            THEN("parts pull disjoint values, covering all")
+            {
+                REQUIRE(parts.size() == 3);
+                std::multiset<int> vals;
+                source >>= for_each >>= [&](int val) { vals.insert(val); };
+                for (auto& part : parts)
+                {
+                    *part >>= for_each >>= [&](int val) { vals.insert(val); };
+                }
+                REQUIRE(vals.size() == 100);
+                REQUIRE(std::set<int>(vals.begin(), vals.end()).size() == 100);
+            }
+        }
+        WHEN("split in more parts than values")
+        {
+            range_source small{ 0, 3 };
+            auto parts = small.split(8);
+            THEN("it splits until no part can be split")
+            {
+                REQUIRE(parts.size() == 2);
+            }
+        }
+    }
+    GIVEN("a source which can't be split")
+    {
+        struct single final : data_source<int>
+        {
+            std::optional<int> next() override
+            {
+                return std::nullopt;
+            }
+        } source;
+        THEN("it has no parts to split off")
+        {
+            REQUIRE(source.try_split() == nullptr);
+            REQUIRE(source.split(4).empty());
+        }
+    }
+}
+
+SCENARIO("Consume a data source in parallel")
+{
+    thread_pool pool{ 3 };
+
+    GIVEN("a splittable source")
+    {
+        range_source source{ 0, 10'000 };
+        WHEN("piped as: source >>= parallel_for_each(pool, 4) >>= stage >>= receiver")
+        {
+            collector received;
+            source >>= parallel_for_each(pool, 4) >>= [](int val) { return val * 2; } >>= &received;
+            THEN("each value is received once, partitions being consumed by several threads")
+            {
+                REQUIRE(received.count == 10'000);
+                REQUIRE(std::set<int>(received.vals.begin(), received.vals.end()).size() == 10'000);
+                REQUIRE(*received.vals.rbegin() == 19'998);
+                REQUIRE(received.threads.size() >= 1);
+            }
+        }
+    }
+    GIVEN("a source which can't be split")
+    {
+        std::vector<int> vals{ 1, 2, 3 };
+        struct vector_source final : data_source<int>
+        {
+            explicit vector_source(const std::vector<int>& vals) :
+                vals_(vals)
+            {}
+            std::optional<int> next() override
+            {
+                return current_ < vals_.size() ? std::optional<int>(vals_[current_++]) : std::nullopt;
+            }
+            const std::vector<int>& vals_;
+            std::size_t current_ = 0;
+        } source{ vals };
+        WHEN("consumed in parallel")
+        {
+            collector received;
+            source >>= parallel_for_each(pool) >>= &received;
+            THEN("it is consumed by the calling thread")
+            {
+                REQUIRE(received.count == 3);
+                REQUIRE(received.threads == std::set<std::thread::id>{ std::this_thread::get_id() });
+            }
+        }
+    }
+    GIVEN("a partition throwing while consumed")
+    {
+        range_source source{ 0, 1000, 900 };
+        THEN("the exception is rethrown once all partitions are consumed")
+        {
+            collector received;
+            REQUIRE_THROWS_AS(source >>= parallel_for_each(pool, 4) >>= &received, std::runtime_error);
+            // Other partitions are consumed entirely, and the failing one up to the value throwing (values aren't read ahead)
+            REQUIRE(received.count == 900);
+        }
+    }
+    GIVEN("a splittable source consumed by a task of a single threaded pool")
+    {
+        thread_pool single{ 1 };
+        range_source source{ 0, 100 };
+        collector received;
+        single.submit([&] { source >>= parallel_for_each(single) >>= &received; });
+        single.wait_idle();
+        THEN("the worker consumes it alone, instead of waiting for parts it would have to consume")
+        {
+            REQUIRE(received.count == 100);
+            REQUIRE(received.threads.size() == 1);
+            REQUIRE(received.threads.count(std::this_thread::get_id()) == 0);
+        }
+    }
+}
@@ -4,6 +4,7 @@
 
 #include <chrono>
 #include <functional>
+#include <memory>
 #include <optional>
 #include <string>
 #include <thread>
@@ -85,6 +86,27 @@ namespace
         }
     };
 
+    // Counts copies (not moves) made of it
+    struct copy_counting_to_int
+    {
+        explicit copy_counting_to_int(int& copies) :
+            copies(&copies)
+        {}
+        copy_counting_to_int(const copy_counting_to_int& rhs) :
+            copies(rhs.copies)
+        {
+            ++*copies;
+        }
+        copy_counting_to_int(copy_counting_to_int&&) = default;
+
+        int operator()(int val) const
+        {
+            return val;
+        }
+
+        int* copies;
+    };
+
     template<typename T>
     struct hello;
 }
@@ -383,6 +405,23 @@ SCENARIO("Compose callables")
             }
         }
     }
+    GIVEN("a mix of callables and composite types")
+    {
+        auto composed1 = assembly::compose(int_to_int(), int_to_string());
+        auto composed2 = assembly::compose(char_to_int(), int_to_int());
+        WHEN("composed in one step")
+        {
+            auto newComposed = assembly::compose(composed1, string_to_char(), composed2, int_to_string());
+            THEN("it is flattened into a single composite type of all callables")
+            {
+                REQUIRE(std::is_same_v<decltype(newComposed), impl::composite_pipe<int_to_int, int_to_string, string_to_char, char_to_int, int_to_int, int_to_string>>);
+            }
+            THEN("it is invoked in order head...tail")
+            {
+                REQUIRE(invocation::invoke(newComposed, 1) == "1");
+            }
+        }
+    }
 }
 
 SCENARIO("compose const reference and const pointer to callables")
@@ -466,6 +505,70 @@ SCENARIO("compose const reference and const pointer to callables")
     }
 }
 
+SCENARIO("compose reference_wrapper and shared_ptr to callables")
+{
+    int copies = 0;
+    copy_counting_to_int heavy{ copies };
+
+    GIVEN("left hand callable and right hand reference_wrapper to callable")
+    {
+        auto callable = int_to_int();
+        auto composite = assembly::compose(int_to_int(), std::ref(callable));
+        THEN("tail of composed is a reference_wrapper")
+        {
+            REQUIRE(std::is_same_v<decltype(composite)::tail_t, std::reference_wrapper<int_to_int>>);
+        }
+        THEN("the composed type is invocable with int")
+        {
+            REQUIRE(meta::is_invocable_v<decltype(composite), int>);
+            REQUIRE(meta::is_invocable_v<std::reference_wrapper<int_to_int>, int>);
+            REQUIRE_FALSE(meta::is_invocable_v<std::reference_wrapper<int_to_int>, std::string>);
+        }
+        THEN("the referenced callable is invoked")
+        {
+            REQUIRE((1 >>= composite) == 1);
+            REQUIRE(callable.callTime > time_point_t{});
+        }
+    }
+    GIVEN("a reference_wrapper to a heavy callable")
+    {
+        auto pipeline = std::cref(heavy) >>= [](int val) { return val + 1; };
+        auto copied = pipeline;
+        THEN("it is never copied along with the pipe")
+        {
+            REQUIRE((1 >>= copied) == 2);
+            REQUIRE(copies == 0);
+        }
+    }
+    GIVEN("a shared_ptr to a heavy callable, shared by two pipes")
+    {
+        auto shared = std::make_shared<copy_counting_to_int>(heavy);
+        copies = 0;
+        auto pipeline1 = shared >>= [](int val) { return val + 1; };
+        auto pipeline2 = [](int val) { return val * 2; } >>= shared;
+        THEN("the callable is owned by both, and never copied")
+        {
+            REQUIRE(std::is_same_v<decltype(pipeline1)::head_t, std::shared_ptr<copy_counting_to_int>>);
+            REQUIRE(meta::is_invocable_v<decltype(pipeline1), int>);
+            REQUIRE((1 >>= pipeline1) == 2);
+            REQUIRE((2 >>= pipeline2) == 4);
+            REQUIRE(shared.use_count() == 3);
+            REQUIRE(copies == 0);
+        }
+    }
+    GIVEN("a reference_wrapper & shared_ptr to interceptors")
+    {
+        auto interceptor = assembly::make_interceptor([](auto&& downstream, int val) { return downstream(val * 10); });
+        auto sharedInterceptor = std::make_shared<decltype(interceptor)>(interceptor);
+        auto pipeline = assembly::compose(std::ref(interceptor), sharedInterceptor, [](int val) { return val + 1; });
+        THEN("they are detected & invoked as interceptors")
+        {
+            REQUIRE(meta::is_invocable_v<decltype(pipeline), int>);
+            REQUIRE((1 >>= pipeline) == 101);
+        }
+    }
+}
+
 SCENARIO("Invoke composed callables")
 {
     GIVEN("callable accepting an rvalue")
@@ -561,6 +664,88 @@ SCENARIO("Implicit conversion")
         }
     }
 }
+SCENARIO("Conversion without copying stages")
+{
+    int copies = 0;
+    auto pipeline = assembly::compose(copy_counting_to_int{ copies }, [](int val) { return std::to_string(val); });
+    copies = 0;
+
+    GIVEN("a pipe converted to std::function")
+    {
+        WHEN("converted as l-value")
+        {
+            std::function<std::string(int)> wrapper = pipeline;
+            THEN("stages are copied")
+            {
+                REQUIRE(copies > 0);
+                REQUIRE(wrapper(1) == "1");
+            }
+        }
+        WHEN("converted as r-value")
+        {
+            std::function<std::string(int)> wrapper = std::move(pipeline);
+            THEN("stages are moved")
+            {
+                REQUIRE(copies == 0);
+                REQUIRE(wrapper(2) == "2");
+            }
+        }
+        WHEN("converted by reference")
+        {
+            std::function<std::string(int)> wrapper = assembly::by_ref(pipeline);
+            THEN("stages are neither copied nor moved, the pipe is invoked in place")
+            {
+                REQUIRE(copies == 0);
+                REQUIRE(wrapper(3) == "3");
+                REQUIRE((4 >>= assembly::by_ref(pipeline)) == "4");
+            }
+        }
+    }
+    GIVEN("a pipe referenced by another pipe")
+    {
+        auto composed = assembly::by_ref(pipeline) >>= [](const std::string& str) { return str.size(); };
+        THEN("the referenced pipe is not copied")
+        {
+            REQUIRE(copies == 0);
+            REQUIRE((10 >>= composed) == 2);
+            REQUIRE_FALSE(meta::is_invocable_v<decltype(assembly::by_ref(pipeline)), std::string>);
+        }
+    }
+}
+SCENARIO("Size of composed pipes")
+{
+    GIVEN("pipes of stateless stages only")
+    {
+        auto twice = [](int val) { return val * 2; };
+        auto negate = [](int val) { return -val; };
+        auto stateless = for_each >>= twice >>= negate;
+        auto interceptors = assembly::compose(unpack, maybe, visit);
+
+        THEN("the stages take no space")
+        {
+            static_assert(sizeof(stateless) == 1);
+            static_assert(sizeof(interceptors) == 1);
+            static_assert(sizeof(assembly::compose(stateless, interceptors)) == 1);
+            int sum = 0;
+            std::vector<int>{ 1, 2 } >>= assembly::compose(stateless, [&](int val) { sum += val; });
+            REQUIRE(sum == -6);
+        }
+    }
+    GIVEN("pipes of stateless & stateful stages")
+    {
+        int_to_int callable;
+        auto twice = [](int val) { return val * 2; };
+        auto offset = [offset = 3](int val) { return val + offset; };
+
+        THEN("only stateful stages (and pointers) take space")
+        {
+            static_assert(sizeof(for_each >>= twice >>= offset) == sizeof(int));
+            static_assert(sizeof(twice >>= &callable) == sizeof(&callable));
+            static_assert(sizeof(twice >>= callable) == sizeof(callable));
+            REQUIRE((1 >>= twice >>= offset) == 5);
+        }
+    }
+}
 SCENARIO("custom pipeline interceptors")
 {
     GIVEN("an interceptor taking first arg as 'auto&& callable' and rest as expected input, and returning tail result")
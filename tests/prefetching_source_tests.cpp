@@ -0,0 +1,117 @@
+#include <pipeable/pipeable.hpp>
+#include <pipeable/prefetching_source.hpp>
+
+#include <catch2/catch.hpp>
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+using namespace pipeable;
+
+namespace
+{
+    // Pulls 0 .. count-1, throws instead of the value 'throwAt' (if any)
+    struct slow_source final : public data_source<int>
+    {
+        explicit slow_source(int count, int throwAt = -1) :
+            count_(count),
+            throwAt_(throwAt)
+        {}
+
+        std::optional<int> next() override
+        {
+            if (current_ == throwAt_)
+            {
+                throw std::runtime_error("decode failed");
+            }
+            pulled.fetch_add(1);
+            return current_ < count_ ? std::optional<int>(current_++) : std::nullopt;
+        }
+
+        std::atomic<int> pulled{ 0 };
+
+    private:
+        int count_;
+        int throwAt_;
+        int current_ = 0;
+    };
+
+    struct buffer_source final : public data_source<std::unique_ptr<int>>
+    {
+        std::optional<std::unique_ptr<int>> next() override
+        {
+            return current_ < 3 ? std::optional<std::unique_ptr<int>>(std::make_unique<int>(current_++)) : std::nullopt;
+        }
+
+    private:
+        int current_ = 0;
+    };
+}
+
+SCENARIO("Prefetching data source")
+{
+    GIVEN("a source wrapped by a prefetching source")
+    {
+        slow_source source{ 1000 };
+        prefetching_source<int> prefetching{ source, 8 };
+
+        THEN("it is a data source")
+        {
+            REQUIRE(std::is_base_of_v<data_source<int>, prefetching_source<int>>);
+        }
+        WHEN("piped as: prefetching_source >>= for_each >>= receiver")
+        {
+            std::vector<int> vals;
+            prefetching >>= for_each >>= [&](int val) { vals.push_back(val); };
+            THEN("all values are pulled, in order")
+            {
+                REQUIRE(vals.size() == 1000);
+                REQUIRE(vals[0] == 0);
+                REQUIRE(vals[999] == 999);
+                REQUIRE_FALSE(prefetching.next().has_value());
+            }
+        }
+    }
+    GIVEN("a prefetching source destroyed before its source is drained")
+    {
+        slow_source source{ 1'000'000 };
+        {
+            prefetching_source<int> prefetching{ source, 4 };
+            REQUIRE(prefetching.next() == 0);
+        }
+        THEN("the background thread stops, having read ahead at most about the buffer depth")
+        {
+            REQUIRE(source.pulled < 1'000'000);
+        }
+    }
+    GIVEN("a source throwing while prefetched")
+    {
+        slow_source source{ 10, 5 };
+        prefetching_source<int> prefetching{ source, 4 };
+        THEN("values pulled before are consumed, then the exception is rethrown")
+        {
+            std::vector<int> vals;
+            REQUIRE_THROWS_AS(prefetching >>= for_each >>= [&](int val) { vals.push_back(val); }, std::runtime_error);
+            REQUIRE(vals == std::vector<int>{ 0, 1, 2, 3, 4 });
+            REQUIRE_FALSE(prefetching.next().has_value());
+        }
+    }
+    GIVEN("a source of move-only values")
+    {
+        buffer_source source;
+        prefetching_source<std::unique_ptr<int>> prefetching{ source };
+        WHEN("iterated")
+        {
+            int sum = 0;
+            for (auto&& val : prefetching)
+            {
+                sum += *val;
+            }
+            THEN("values are moved through the buffer")
+            {
+                REQUIRE(sum == 3);
+            }
+        }
+    }
+}
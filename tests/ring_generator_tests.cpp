@@ -0,0 +1,159 @@
+#include <pipeable/ring_generator.hpp>
+
+#include <catch2/catch.hpp>
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace pipeable;
+
+namespace
+{
+    struct tick
+    {
+        std::uint64_t sequence = 0;
+        std::uint64_t checksum = 0;
+    };
+
+    struct recording_consumer
+    {
+        void operator()(const tick& value)
+        {
+            values.push_back(value.sequence);
+        }
+        std::vector<std::uint64_t> values;
+    };
+}
+
+SCENARIO("Ring buffer generator")
+{
+    GIVEN("a small ring generator with multiple consumers")
+    {
+        ring_generator<tick> ring{ 8 };
+        recording_consumer first;
+        recording_consumer second;
+        ring += &first;
+        ring += &second;
+        ring.start();
+
+        WHEN("more values than its capacity are published")
+        {
+            const auto count = 10'000;
+            for (auto i = 0; i < count; ++i)
+            {
+                ring.publish([&](tick& slot) { slot.sequence = std::uint64_t(i); });
+            }
+            ring.stop();
+            THEN("each consumer reads all values, in order")
+            {
+                REQUIRE(first.values.size() == count);
+                REQUIRE(second.values.size() == count);
+                for (auto i = 0; i < count; ++i)
+                {
+                    REQUIRE(first.values[i] == std::uint64_t(i));
+                    REQUIRE(second.values[i] == std::uint64_t(i));
+                }
+            }
+        }
+    }
+    GIVEN("a ring generator with a consumer depending on two others")
+    {
+        ring_generator<tick> ring{ 16 };
+        std::atomic<std::uint64_t> journaled = 0;
+        std::atomic<std::uint64_t> replicated = 0;
+        bool orderViolated = false;
+        std::uint64_t processed = 0;
+
+        auto& journal = ring.add_consumer([&](const tick&) { ++journaled; });
+        auto& replicate = ring.add_consumer([&](const tick&) { ++replicated; });
+        ring.add_consumer([&](const tick&) {
+            // Both dependencies are done with this (and all earlier) values
+            orderViolated |= journaled <= processed || replicated <= processed;
+            ++processed;
+        }, { &journal, &replicate });
+        ring.start();
+
+        WHEN("values are published by multiple producer threads, in batches")
+        {
+            const auto producerCount = 4;
+            const auto perProducer = 5'000;
+            std::atomic<std::uint64_t> nextSequence = 0;
+            std::vector<std::thread> producers;
+            for (auto p = 0; p < producerCount; ++p)
+            {
+                producers.emplace_back([&] {
+                    for (auto i = 0; i < perProducer; i += 10)
+                    {
+                        ring.publish_batch(10, [&](tick& slot, std::size_t) { slot.sequence = nextSequence++; });
+                    }
+                });
+            }
+            for (auto& producer : producers)
+            {
+                producer.join();
+            }
+            ring.stop();
+
+            THEN("the dependent consumer reads each value only after its dependencies")
+            {
+                REQUIRE(journaled == producerCount * perProducer);
+                REQUIRE(replicated == producerCount * perProducer);
+                REQUIRE(processed == producerCount * perProducer);
+                REQUIRE(journal.sequence() == producerCount * perProducer);
+                REQUIRE_FALSE(orderViolated);
+            }
+        }
+    }
+    GIVEN("a ring generator")
+    {
+        ring_generator<int> ring{ 4 };
+        std::vector<int> received;
+        ring += [&](int value) { received.push_back(value); };
+        ring.start();
+
+        WHEN("used as sink of a pipe")
+        {
+            1 >>= ring;
+            2 >>= [](int value) { return value * 10; } >>= &ring;
+            ring.stop();
+            THEN("piped values are published")
+            {
+                REQUIRE(received == std::vector{ 1, 20 });
+            }
+        }
+        THEN("consumers can't be added once started")
+        {
+            REQUIRE_THROWS_AS(ring += [](int) {}, std::logic_error);
+        }
+    }
+    GIVEN("a small ring generator with a consumer throwing on some values")
+    {
+        ring_generator<int> ring{ 4 };
+        std::vector<int> received;
+        auto& throwing = ring += [&](int value) {
+            if (value % 2 == 0)
+            {
+                throw std::runtime_error("even");
+            }
+            received.push_back(value);
+        };
+        ring.start();
+
+        WHEN("more values than its capacity are published")
+        {
+            for (auto i = 0; i < 20; ++i)
+            {
+                i >>= ring;
+            }
+            ring.stop();
+            THEN("the consumer goes on with later values, and failures are counted")
+            {
+                REQUIRE(received == std::vector{ 1, 3, 5, 7, 9, 11, 13, 15, 17, 19 });
+                REQUIRE(throwing.sequence() == 20);
+                REQUIRE(throwing.failures() == 10);
+            }
+        }
+    }
+}
@@ -0,0 +1,159 @@
+#include <pipeable/pipeable.hpp>
+#include <pipeable/stage_registry.hpp>
+
+#include <catch2/catch.hpp>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace pipeable;
+
+namespace
+{
+    // Passes on even values only
+    struct even_filter final : batch_stage<int, int>
+    {
+        span<const int> process(span<const int> input) override
+        {
+            output.clear();
+            for (int val : input)
+            {
+                if (val % 2 == 0)
+                {
+                    output.push_back(val);
+                }
+            }
+            return output;
+        }
+
+        std::vector<int> output;
+    };
+
+    stage_registry make_registry()
+    {
+        stage_registry registry;
+        registry.add<int>("scale", [](const stage_registry::args_t& args) {
+            return [factor = std::stoi(args.at(0))](int val) { return val * factor; };
+        });
+        registry.add<int>("offset", [](const stage_registry::args_t& args) {
+            const int offset = std::stoi(args.at(0));
+            // A compile time pipe is a single stage
+            return assembly::compose([offset](int val) { return val + offset; }, [](int val) { return val; });
+        });
+        registry.add<int>("even", [](const stage_registry::args_t&) {
+            return std::make_unique<even_filter>();
+        });
+        registry.add<int>("format", [](const stage_registry::args_t&) {
+            return [](int val) { return std::to_string(val); };
+        });
+        return registry;
+    }
+}
+
+SCENARIO("Parse a pipe specification")
+{
+    GIVEN("a specification of stages & arguments")
+    {
+        const auto spec = stage_registry::parse("scale 2 >>=offset  -1>>= format");
+        THEN("stages are parsed in order, with their arguments")
+        {
+            REQUIRE(spec.size() == 3);
+            REQUIRE(spec[0].name == "scale");
+            REQUIRE(spec[0].args == std::vector<std::string>{ "2" });
+            REQUIRE(spec[1].name == "offset");
+            REQUIRE(spec[1].args == std::vector<std::string>{ "-1" });
+            REQUIRE(spec[2].name == "format");
+            REQUIRE(spec[2].args.empty());
+        }
+    }
+    GIVEN("a specification with an empty stage")
+    {
+        THEN("parsing throws")
+        {
+            REQUIRE_THROWS_AS(stage_registry::parse("scale 2 >>= >>= format"), std::invalid_argument);
+            REQUIRE_THROWS_AS(stage_registry::parse(">>= format"), std::invalid_argument);
+        }
+    }
+    GIVEN("a specification ending with a separator")
+    {
+        THEN("parsing throws, whether trailed by whitespace or not")
+        {
+            REQUIRE_THROWS_AS(stage_registry::parse("scale 2 >>="), std::invalid_argument);
+            REQUIRE_THROWS_AS(stage_registry::parse("scale 2 >>= "), std::invalid_argument);
+        }
+    }
+    GIVEN("an empty specification")
+    {
+        THEN("it parses to no stages")
+        {
+            REQUIRE(stage_registry::parse("").empty());
+        }
+    }
+}
+
+SCENARIO("Build pipes at runtime")
+{
+    auto registry = make_registry();
+
+    GIVEN("a pipe built from a specification")
+    {
+        auto pipe = registry.build<int, std::string>("scale 3 >>= offset 1 >>= even >>= format");
+        REQUIRE(pipe.stages() == 4);
+
+        WHEN("invoked with a batch")
+        {
+            const std::vector<int> values{ 1, 2, 3, 4, 5 };
+            const auto output = pipe(values);
+            THEN("each stage processes the whole batch in turn")
+            {
+                REQUIRE(std::vector<std::string>(output.begin(), output.end()) == std::vector<std::string>{ "4", "10", "16" });
+            }
+            AND_WHEN("invoked again")
+            {
+                const auto again = pipe(std::vector<int>{ 7 });
+                THEN("stage buffers are reused")
+                {
+                    REQUIRE(std::vector<std::string>(again.begin(), again.end()) == std::vector<std::string>{ "22" });
+                }
+            }
+        }
+        WHEN("piped as: batch >>= &pipe >>= receiver")
+        {
+            std::vector<std::string> received;
+            std::vector<int>{ 1, 3 } >>= &pipe >>= [&](span<const std::string> batch) { received.assign(batch.begin(), batch.end()); };
+            THEN("the output batch is passed on")
+            {
+                REQUIRE(received == std::vector<std::string>{ "4", "10" });
+            }
+        }
+    }
+    GIVEN("a pipe built from parsed stages")
+    {
+        auto pipe = registry.build<int, int>(std::vector<stage_spec>{ { "scale", { "2" } }, { "scale", { "5" } } });
+        THEN("a stage may be used more than once")
+        {
+            REQUIRE(pipe(std::vector<int>{ 1 })[0] == 10);
+        }
+    }
+    GIVEN("invalid specifications")
+    {
+        THEN("building throws")
+        {
+            REQUIRE_THROWS_AS((registry.build<int, int>("scale 2 >>= unknown")), std::invalid_argument);
+            REQUIRE_THROWS_AS((registry.build<int, int>("format >>= scale 2")), std::invalid_argument);
+            REQUIRE_THROWS_AS((registry.build<int, int>("scale 2 >>= format")), std::invalid_argument);
+            REQUIRE_THROWS_AS((registry.build<std::string, int>("scale 2")), std::invalid_argument);
+            REQUIRE_THROWS_AS((registry.build<int, int>("")), std::invalid_argument);
+            REQUIRE_THROWS_AS((registry.build<int, int>("scale")), std::out_of_range);
+        }
+    }
+    GIVEN("a stage registered twice")
+    {
+        THEN("registration throws")
+        {
+            REQUIRE(registry.contains("scale"));
+            REQUIRE_THROWS_AS(registry.add<int>("scale", [](const stage_registry::args_t&) { return [](int val) { return val; }; }), std::invalid_argument);
+        }
+    }
+}
@@ -0,0 +1,122 @@
+#include <pipeable/pipeable.hpp>
+#include <pipeable/static_data_source.hpp>
+
+#include <catch2/catch.hpp>
+#include <string>
+#include <vector>
+
+using namespace pipeable;
+
+namespace
+{
+    // Pulls 0 .. count-1, one value at a time
+    struct counter : static_data_source<counter, int>
+    {
+        explicit counter(int count) :
+            count_(count)
+        {}
+
+        std::optional<int> next()
+        {
+            ++nextCalls;
+            return current_ < count_ ? std::optional<int>(current_++) : std::nullopt;
+        }
+
+        int nextCalls = 0;
+
+    private:
+        int count_;
+        int current_ = 0;
+    };
+
+    // Same values, filling blocks
+    struct batched_counter : static_data_source<batched_counter, int>
+    {
+        explicit batched_counter(int count) :
+            count_(count)
+        {}
+
+        std::optional<int> next()
+        {
+            return current_ < count_ ? std::optional<int>(current_++) : std::nullopt;
+        }
+
+        std::size_t next_batch(span<int> values)
+        {
+            ++batchCalls;
+            std::size_t pulled = 0;
+            for (; pulled < values.size() && current_ < count_; ++pulled)
+            {
+                values[pulled] = current_++;
+            }
+            return pulled;
+        }
+
+        int batchCalls = 0;
+
+    private:
+        int count_;
+        int current_ = 0;
+    };
+}
+
+SCENARIO("Static data source")
+{
+    GIVEN("a static data source implementing next")
+    {
+        counter source{ 10 };
+        THEN("for_each pulls values one by one")
+        {
+            REQUIRE_FALSE(counter::pulls_in_batches<counter>);
+        }
+        WHEN("iterated")
+        {
+            std::vector<int> vals;
+            for (auto val : source)
+            {
+                vals.push_back(val);
+            }
+            THEN("each value is iterated in order")
+            {
+                REQUIRE(vals == std::vector<int>{ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 });
+                REQUIRE(source.nextCalls == 11);
+            }
+        }
+        WHEN("piped as: static_data_source >>= for_each >>= stage >>= receiver")
+        {
+            std::vector<std::string> vals;
+            source >>= for_each >>= [](int val) { return std::to_string(val); } >>= [&](std::string&& val) { vals.push_back(std::move(val)); };
+            THEN("each value is passed through the pipe")
+            {
+                REQUIRE(vals.size() == 10);
+                REQUIRE(vals[9] == "9");
+            }
+        }
+        WHEN("pulled in a batch larger than its values")
+        {
+            std::vector<int> vals(16);
+            const auto pulled = source.next_batch(vals);
+            THEN("the default pulls values through next until there are none left")
+            {
+                REQUIRE(pulled == 10);
+                REQUIRE(vals[9] == 9);
+            }
+        }
+    }
+    GIVEN("a static data source defining next_batch")
+    {
+        batched_counter source{ 1000 };
+        WHEN("piped as: static_data_source >>= for_each >>= receiver")
+        {
+            std::vector<int> vals;
+            source >>= for_each >>= [&](int val) { vals.push_back(val); };
+            THEN("values are pulled one block at a time, in order")
+            {
+                REQUIRE(batched_counter::pulls_in_batches<batched_counter>);
+                REQUIRE(vals.size() == 1000);
+                REQUIRE(vals[999] == 999);
+                REQUIRE(source.batchCalls == (1000 + batched_counter::batch_size - 1) / batched_counter::batch_size + 1);
+            }
+        }
+    }
+}
@@ -0,0 +1,122 @@
+#include <pipeable/static_generator.hpp>
+#include <pipeable/data_generator.hpp>
+
+#include <catch2/catch.hpp>
+#include <string>
+
+using namespace pipeable;
+
+namespace
+{
+    struct int_receiver
+    {
+        void operator()(int val)
+        {
+            receivedInt = val;
+        }
+        int receivedInt = 0;
+    };
+    struct string_receiver
+    {
+        void operator()(std::string&& val)
+        {
+            receivedStr = std::move(val);
+        }
+        std::string receivedStr;
+    };
+    struct int_to_int
+    {
+        int operator()(int val) const
+        {
+            return val * 2;
+        }
+    };
+}
+
+SCENARIO("Static data generator")
+{
+    GIVEN("a static generator with receivers: receiver1, receiver2")
+    {
+        int_receiver receiver1, receiver2;
+        static_generator generator(&receiver1, &receiver2);
+
+        THEN("receiver types are deduced")
+        {
+            REQUIRE(std::is_same_v<decltype(generator), static_generator<int_receiver*, int_receiver*>>);
+        }
+        THEN("it is invocable with input accepted by all receivers")
+        {
+            REQUIRE(meta::is_invocable_v<decltype(generator), int>);
+            REQUIRE_FALSE(meta::is_invocable_v<decltype(generator), std::string>);
+        }
+        WHEN("invoked")
+        {
+            generator(1);
+            THEN("all receivers receive the value")
+            {
+                REQUIRE(receiver1.receivedInt == 1);
+                REQUIRE(receiver2.receivedInt == 1);
+            }
+        }
+        WHEN("piped as: value >>= generator")
+        {
+            2 >>= generator;
+            THEN("all receivers receive the value")
+            {
+                REQUIRE(receiver1.receivedInt == 2);
+                REQUIRE(receiver2.receivedInt == 2);
+            }
+        }
+        WHEN("piped as: value >>= callable >>= generator")
+        {
+            2 >>= int_to_int() >>= generator;
+            THEN("all receivers receive the transformed value")
+            {
+                REQUIRE(receiver1.receivedInt == 4);
+                REQUIRE(receiver2.receivedInt == 4);
+            }
+        }
+        WHEN("registered as receiver of a data generator")
+        {
+            data_generator<int> dynamicGenerator;
+            dynamicGenerator += &generator;
+            dynamicGenerator(3);
+            THEN("all receivers receive the value")
+            {
+                REQUIRE(receiver1.receivedInt == 3);
+                REQUIRE(receiver2.receivedInt == 3);
+            }
+        }
+    }
+    GIVEN("a static generator with receivers accepting r-value reference")
+    {
+        string_receiver receiver1, receiver2;
+        static_generator generator(&receiver1, &receiver2);
+
+        THEN("it is not invocable with an l-value (receivers can't move from it)")
+        {
+            REQUIRE_FALSE(meta::is_invocable_v<decltype(generator), std::string&>);
+        }
+        THEN("it is not invocable with an r-value (only the last receiver may move from it)")
+        {
+            REQUIRE_FALSE(meta::is_invocable_v<decltype(generator), std::string&&>);
+        }
+    }
+    GIVEN("a static generator with receivers accepting by value")
+    {
+        std::string received1, received2;
+        static_generator generator(
+            [&](std::string val) { received1 = std::move(val); },
+            [&](std::string val) { received2 = std::move(val); });
+
+        WHEN("invoked with an r-value")
+        {
+            generator(std::string("dummy"));
+            THEN("all receivers receive the value (only the last may move from it)")
+            {
+                REQUIRE(received1 == "dummy");
+                REQUIRE(received2 == "dummy");
+            }
+        }
+    }
+}